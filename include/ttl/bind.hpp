@@ -6,6 +6,12 @@
 #include <ttl/tree/bind.hpp>
 #include <ttl/tree/node.hpp>
 
+#include <array>
+#include <cstddef>
+#include <mdspan>
+#include <type_traits>
+#include <utility>
+
 namespace ttl
 {
     template <scalar A>
@@ -20,7 +26,67 @@ namespace ttl
         return tree::bind<A const, "">(std::move(a));
     }
 
+    namespace _
+    {
+        /// Check to see if binding `A` to `index` should be lowered to a
+        /// strided view (see `ttl::project`).
+        ///
+        /// This requires that the index have some projections and that `A` is
+        /// an mdspan with a strided layout whose accessor can offset its data
+        /// handle.
+        template <class A, index_string index>
+        concept lower_projection = index.count(projected_index) != 0 and requires(std::remove_cvref_t<A> const& a) {
+            requires std::remove_cvref_t<A>::mapping_type::is_always_strided();
+            a.mapping().stride(0);
+            a.accessor().offset(a.data_handle(), 0zu);
+        };
+    }
+
+    /// Project a strided mdspan to a lower rank, zero-copy, strided view.
+    ///
+    /// The projected offsets are folded into the data handle and the
+    /// remaining slots keep their extents and strides, so A(i,2) becomes a
+    /// rank-1 layout_stride view of the third column of A. The resulting view
+    /// needs no index remapping and can use any of the strided fast paths.
+    template <class A, index_string _index>
+    inline constexpr auto project(A const& a, index<_index> const& id)
+    {
+        using M = std::remove_cvref_t<A>;
+        using index_type = typename M::index_type;
+        using accessor_type = typename M::accessor_type::offset_policy;
+
+        static constexpr auto map = [] {
+            std::array<std::size_t, _index.unprojected().size()> out;
+            for (std::size_t i = 0, j = 0; i < _index.size(); ++i) {
+                if (_index[i] != projected_index) {
+                    out[j++] = i;
+                }
+            }
+            return out;
+        }();
+
+        auto const extents = select_extents(index_sequence_from_array<map>, a.extents());
+        using extents_type = std::remove_cv_t<decltype(extents)>;
+
+        std::array<index_type, extents_type::rank()> strides;
+        std::size_t offset = 0;
+        for (std::size_t i = 0, j = 0; i < _index.size(); ++i) {
+            if (_index[i] != projected_index) {
+                strides[j++] = a.mapping().stride(i);
+            }
+            else {
+                offset += id[i] * a.mapping().stride(i);
+            }
+        }
+
+        return std::mdspan<typename M::element_type, extents_type, std::layout_stride, accessor_type>(
+            a.accessor().offset(a.data_handle(), offset),
+            std::layout_stride::mapping<extents_type>(extents, strides),
+            accessor_type(a.accessor()));
+    }
+
     template <tensor A, index_string... _index>
+        requires(not _::lower_projection<A, (_index + ...)>)
     inline constexpr auto bind(A& a, index<_index> const&... ids)
         -> tree::bind<A&, (_index + ...)>
     {
@@ -28,14 +94,25 @@ namespace ttl
     }
 
     template <tensor A, index_string... _index>
+        requires(not _::lower_projection<A, (_index + ...)>)
     inline constexpr auto bind(A const&& a, index<_index> const&... ids)
         -> tree::bind<A const, (_index + ...)>
     {
         return tree::bind<A const, (_index + ...)>(std::move(a), (ids + ...));
     }
 
+    /// Bind a projection of a strided mdspan by binding its projected view.
+    template <tensor A, index_string... _index>
+        requires _::lower_projection<A, (_index + ...)>
+    inline constexpr auto bind(A const& a, index<_index> const&... ids)
+    {
+        static constexpr auto str = (_index + ...);
+        auto view = project(a, (ids + ...));
+        return tree::bind<decltype(view) const, str.unprojected()>(std::move(view));
+    }
+
     template <tensor A, class... Index>
-        requires(std::integral<Index> or ...)
+        requires((std::integral<Index> or ...) and not (is_offset_index<Index> or ...))
     inline constexpr auto bind(A&& a, Index const&... ids)
     // -> decltype(bind((A&&)a, ttl::index(ids)...))
     // https://github.com/llvm/llvm-project/issues/54440
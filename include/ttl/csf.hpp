@@ -0,0 +1,364 @@
+#pragma once
+
+#include <ttl/bind.hpp>
+#include <ttl/evaluate.hpp>
+#include <ttl/extents.hpp>
+#include <ttl/index.hpp>
+#include <ttl/parallel.hpp>
+#include <ttl/tensor_traits.hpp>
+#include <ttl/tree/node.hpp>
+#include <ttl/tree/product.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <mdspan>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ttl
+{
+    /// A non-owning view of a rank-N compressed sparse fiber (CSF) tensor.
+    ///
+    /// The nonzeros are stored as a forest with one level per slot, in slot
+    /// order. Level `l` has one node per distinct prefix (i0,...,il) and
+    /// `fids[l]` stores the index `il` of each node. For l < N - 1 the
+    /// children of node `p` are [fptr[l][p], fptr[l][p+1]) in level l + 1, and
+    /// the leaves line up with `values`. Siblings must be sorted by their
+    /// index.
+    ///
+    /// A CSR matrix is a rank-2 CSF tensor whose root level stores every row.
+    template <class T, std::size_t N, std::integral I = std::size_t>
+    struct csf_span {
+        static_assert(N >= 2);
+
+        using element_type = T;
+        using value_type = std::remove_cv_t<T>;
+        using index_type = I;
+
+        std::span<T> _values;
+        std::array<std::span<I const>, N - 1> _fptr;
+        std::array<std::span<I const>, N> _fids;
+        std::dextents<std::size_t, N> _extents;
+
+        constexpr csf_span(
+            std::span<T> values,
+            std::array<std::span<I const>, N - 1> fptr,
+            std::array<std::span<I const>, N> fids,
+            std::dextents<std::size_t, N> extents)
+            : _values(values)
+            , _fptr(fptr)
+            , _fids(fids)
+            , _extents(extents)
+        {
+            assert(_values.size() == _fids[N - 1].size());
+            for (std::size_t l = 0; l < N - 1; ++l) {
+                assert(_fptr[l].size() == _fids[l].size() + 1);
+                assert(_fptr[l].back() == _fids[l + 1].size());
+            }
+        }
+
+        constexpr auto extents() const -> std::dextents<std::size_t, N>
+        {
+            return _extents;
+        }
+
+        constexpr auto values() const -> std::span<T>
+        {
+            return _values;
+        }
+
+        constexpr auto fptr(std::size_t l) const -> std::span<I const>
+        {
+            return _fptr[l];
+        }
+
+        constexpr auto fids(std::size_t l) const -> std::span<I const>
+        {
+            return _fids[l];
+        }
+
+        constexpr auto nonzeros() const -> std::size_t
+        {
+            return _values.size();
+        }
+
+        /// Find the value at (i...), returning a value-initialized scalar if it
+        /// isn't stored.
+        constexpr auto operator[](std::integral auto... i) const -> value_type
+            requires(sizeof...(i) == N)
+        {
+            std::size_t const ind[] { std::size_t(i)... };
+            std::size_t begin = 0;
+            std::size_t end = _fids[0].size();
+            for (std::size_t l = 0; l < N; ++l) {
+                auto const fids = _fids[l];
+                auto const it = std::lower_bound(fids.begin() + begin, fids.begin() + end, ind[l]);
+                if (it == fids.begin() + end or std::size_t(*it) != ind[l]) {
+                    return value_type {};
+                }
+                std::size_t const p = it - fids.begin();
+                if (l == N - 1) {
+                    return _values[p];
+                }
+                begin = _fptr[l][p];
+                end = _fptr[l][p + 1];
+            }
+            std::unreachable();
+        }
+
+        /// Tensor indexing.
+        constexpr auto operator()(this auto const& self, is_index auto... i)
+            -> decltype(ttl::bind(csf_span(self), ttl::index(i)...))
+        {
+            static_assert(sizeof...(i) == N);
+            return ttl::bind(csf_span(self), ttl::index(i)...);
+        }
+    };
+
+    /// CSF tensors are evaluated by searching each level of the forest.
+    template <class T, std::size_t N, class I>
+    struct tensor_traits<csf_span<T, N, I>> {
+        using span = csf_span<T, N, I>;
+
+        static constexpr auto extents(span const& s)
+        {
+            return s.extents();
+        }
+
+        template <std::integral... J>
+            requires(sizeof...(J) == N)
+        static constexpr auto evaluate(span const& s, J... j)
+            -> typename span::value_type
+        {
+            return s[j...];
+        }
+    };
+
+    namespace _
+    {
+        template <class>
+        struct is_csf : std::false_type {
+        };
+
+        template <class T, std::size_t N, class I>
+        struct is_csf<csf_span<T, N, I>> : std::true_type {
+        };
+
+        /// The fused MTTKRP kernel (see `ttl::mttkrp`).
+        template <class M, class X, class... F>
+        struct mttkrp {
+            using _x = tree::_::is_bind<std::remove_cvref_t<X>>;
+            using _m = tree::_::is_bind<std::remove_cvref_t<M>>;
+
+            static_assert(_x::value and is_csf<typename _x::tensor_type>::value, "The tensor must be a bound csf_span.");
+            static_assert(_m::value and _m::index.size() == 2, "The output must be a bound matrix.");
+
+            static constexpr auto ix = _x::index;
+            static constexpr std::size_t N = ix.size();
+
+            static_assert(ix.outer().size() == N, "The tensor must be bound to distinct indices.");
+            static_assert(sizeof...(F) == N - 1, "There must be one factor for each contracted index.");
+
+            /// The output index `o` and the rank index `r`.
+            static constexpr char o = ix.count(_m::index[0]) ? _m::index[0] : _m::index[1];
+            static constexpr char r = ix.count(_m::index[0]) ? _m::index[1] : _m::index[0];
+            static constexpr std::size_t mode = ix.index_of(o);
+
+            static_assert(ix.count(o) == 1 and ix.count(r) == 0, "The output must bind one tensor index and the rank index.");
+            static_assert(((tree::matrix_bind<F> and tree::_::is_bind<std::remove_cvref_t<F>>::index.count(r) == 1) && ...),
+                          "The factors must be matrices bound to the rank index.");
+
+            /// The non-rank index of each factor.
+            static constexpr std::array<char, sizeof...(F)> fc {
+                (tree::_::is_bind<std::remove_cvref_t<F>>::index[0] == r
+                     ? tree::_::is_bind<std::remove_cvref_t<F>>::index[1]
+                     : tree::_::is_bind<std::remove_cvref_t<F>>::index[0])...
+            };
+
+            /// The factor that corresponds to each level of the tensor.
+            static constexpr auto factor = [] {
+                std::array<std::size_t, N> out {};
+                for (std::size_t l = 0; l < N; ++l) {
+                    out[l] = sizeof...(F);
+                    for (std::size_t f = 0; f < sizeof...(F); ++f) {
+                        if (fc[f] == ix[l]) {
+                            out[l] = f;
+                        }
+                    }
+                }
+                return out;
+            }();
+
+            static_assert([] {
+                for (std::size_t l = 0; l < N; ++l) {
+                    if ((l == mode) != (factor[l] == sizeof...(F))) {
+                        return false;
+                    }
+                }
+                return true;
+            }(), "The factors must bind each contracted tensor index once.");
+
+            using accumulator_type = ttl::accumulator_type<M>;
+
+            /// Evaluate the factor for level `l` at (c, s), where `s` is the
+            /// rank index.
+            template <std::size_t l>
+            static constexpr auto _factor(std::tuple<F const&...> const& fs, std::size_t c, std::size_t s)
+            {
+                auto const& f = std::get<factor[l]>(fs);
+                if constexpr (tree::_::is_bind<std::remove_cvref_t<decltype(f)>>::index[0] == r) {
+                    return evaluate(f, s, c);
+                }
+                else {
+                    return evaluate(f, c, s);
+                }
+            }
+
+            /// Evaluate the output at (c, s), where `s` is the rank index.
+            static constexpr auto _output(M& m, std::size_t c, std::size_t s) -> decltype(auto)
+            {
+                if constexpr (_m::index[0] == r) {
+                    return evaluate(m, s, c);
+                }
+                else {
+                    return evaluate(m, c, s);
+                }
+            }
+
+            /// Visit the subtree rooted at node `q` in level `l`.
+            ///
+            /// `partial` holds the product of the factor rows along the path
+            /// to `q`, and `scratch` has space for one row for each level
+            /// below. The factor row for the output mode is skipped, so each
+            /// nonzero is combined with the product of the other factor rows
+            /// without ever forming the Khatri-Rao product.
+            template <std::size_t l>
+            static constexpr void _visit(
+                M& m,
+                typename _x::tensor_type const& x,
+                std::tuple<F const&...> const& fs,
+                std::size_t q,
+                std::size_t co,
+                std::size_t R,
+                accumulator_type const* partial,
+                accumulator_type* scratch)
+            {
+                std::size_t const c = x.fids(l)[q];
+
+                if constexpr (l == N - 1) {
+                    auto const v = x.values()[q];
+                    if constexpr (l == mode) {
+                        for (std::size_t s = 0; s != R; ++s) {
+                            auto&& y = _output(m, c, s);
+                            y = y + v * partial[s];
+                        }
+                    }
+                    else {
+                        for (std::size_t s = 0; s != R; ++s) {
+                            auto&& y = _output(m, co, s);
+                            y = y + v * partial[s] * _factor<l>(fs, c, s);
+                        }
+                    }
+                }
+                else {
+                    accumulator_type const* next = partial;
+                    if constexpr (l == mode) {
+                        co = c;
+                    }
+                    else {
+                        for (std::size_t s = 0; s != R; ++s) {
+                            scratch[s] = partial[s] * _factor<l>(fs, c, s);
+                        }
+                        next = scratch;
+                    }
+
+                    auto const fptr = x.fptr(l);
+                    for (std::size_t p = fptr[q], e = fptr[q + 1]; p != e; ++p) {
+                        _visit<l + 1>(m, x, fs, p, co, R, next, scratch + R);
+                    }
+                }
+            }
+
+            static constexpr void apply(M& m, X const& x, F const&... f)
+            {
+                auto const& t = x._a;
+                auto const fs = std::tuple<F const&...>(f...);
+                std::size_t const R = ttl::extent(m, _m::index.index_of(r));
+
+                for (std::size_t i = 0, e = ttl::extent(m, _m::index.index_of(o)); i != e; ++i) {
+                    for (std::size_t s = 0; s != R; ++s) {
+                        _output(m, i, s) = accumulator_type {};
+                    }
+                }
+
+                // When the output mode is the root level each root writes its
+                // own row, so the roots can be partitioned across threads, in
+                // ranges with roughly equal numbers of nonzeros.
+                auto const roots = t.fids(0).size();
+                auto const leaf = [&](std::size_t q) -> std::size_t {
+                    // The position of the first nonzero below the root `q`.
+                    for (std::size_t l = 0; l + 1 < N; ++l) {
+                        q = t.fptr(l)[q];
+                    }
+                    return q;
+                };
+                auto const partition = [&](std::size_t n, std::size_t nt) -> std::size_t {
+                    if (n == nt) {
+                        return roots;
+                    }
+                    auto const target = leaf(0) + (leaf(roots) - leaf(0)) * n / nt;
+                    std::size_t lo = 0;
+                    std::size_t hi = roots;
+                    while (lo < hi) {
+                        auto const mid = lo + (hi - lo) / 2;
+                        if (leaf(mid) < target) {
+                            lo = mid + 1;
+                        }
+                        else {
+                            hi = mid;
+                        }
+                    }
+                    return lo;
+                };
+
+                std::size_t nt = 1;
+                if !consteval {
+                    if constexpr (mode == 0) {
+                        nt = parallel_threads(t.nonzeros());
+                    }
+                }
+
+                parallel_for(nt, [&](std::size_t n) {
+                    std::vector<accumulator_type> scratch((N + 1) * R);
+                    std::fill_n(scratch.begin(), R, accumulator_type(1));
+                    for (std::size_t q = partition(n, nt), e = partition(n + 1, nt); q < e; ++q) {
+                        _visit<0>(m, t, fs, q, 0, R, scratch.data(), scratch.data() + R);
+                    }
+                });
+            }
+        };
+    }
+
+    /// Compute the matricized tensor times Khatri-Rao product (MTTKRP) of a
+    /// sparse tensor, e.g., M(i,r) = X(i,j,k) * B(j,r) * C(k,r).
+    ///
+    /// The rank index `r` is shared by the output and all of the factors but
+    /// it is not summed, so this can't be written as a `mul` expression. Each
+    /// nonzero is visited once, and the factor rows along each fiber are
+    /// multiplied once per fiber rather than once per nonzero.
+    ///
+    /// @param m The output, bound to one tensor index and the rank index.
+    /// @param x A bound csf_span.
+    /// @param f The factors, each bound to one tensor index and the rank index.
+    template <class M, class X, class... F>
+    inline constexpr void mttkrp(M&& m, X const& x, F const&... f)
+    {
+        _::mttkrp<std::remove_reference_t<M>, X, F...>::apply(m, x, f...);
+    }
+}
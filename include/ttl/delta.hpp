@@ -0,0 +1,118 @@
+#pragma once
+
+#include <ttl/bind.hpp>
+#include <ttl/evaluate.hpp>
+#include <ttl/extents.hpp>
+#include <ttl/index.hpp>
+#include <ttl/tensor.hpp>
+
+#include <cstddef>
+#include <mdspan>
+#include <type_traits>
+
+namespace ttl
+{
+    /// The n x n Kronecker delta, i.e., an identity matrix without storage.
+    ///
+    /// Bound deltas are diagonal operands (see `tree::diagonal_bind`), so
+    /// delta(i,j) * A(j,k) is evaluated as A(i,k) without a contraction loop,
+    /// and assignments rename the index instead (see `tree::_::simplify`).
+    template <class T = int, std::size_t N = std::dynamic_extent>
+    struct kronecker_delta {
+        using value_type = T;
+
+        static constexpr bool is_diagonal = true;
+        static constexpr bool is_identity = true;
+
+        std::extents<std::size_t, N, N> _extents;
+
+        constexpr kronecker_delta()
+            requires(N != std::dynamic_extent)
+        = default;
+
+        constexpr explicit kronecker_delta(std::size_t n)
+            : _extents(n, n)
+        {
+        }
+
+        constexpr auto extents() const -> std::extents<std::size_t, N, N>
+        {
+            return _extents;
+        }
+
+        constexpr auto operator[](std::size_t i, std::size_t j) const -> value_type
+        {
+            return value_type(i == j);
+        }
+
+        /// Tensor indexing.
+        constexpr auto operator()(this auto const& self, is_index auto... i)
+            -> decltype(ttl::bind(kronecker_delta(self), ttl::index(i)...))
+        {
+            static_assert(sizeof...(i) == 2);
+            return ttl::bind(kronecker_delta(self), ttl::index(i)...);
+        }
+    };
+
+    /// A diagonal matrix view of a rank-1 tensor.
+    ///
+    /// Bound diagonal matrices are diagonal operands (see
+    /// `tree::diagonal_bind`), so D(i,j) * A(j,k) is evaluated as a row
+    /// scaling of A without a contraction loop.
+    template <tensor X>
+    struct diagonal_matrix {
+        static_assert(rank<X> == 1, "Diagonal matrices wrap rank-1 tensors.");
+
+        using value_type = std::remove_cvref_t<scalar_type<X const&>>;
+
+        static constexpr bool is_diagonal = true;
+        static constexpr std::size_t N = extents_type<X>::static_extent(0);
+
+        X _x;
+
+        constexpr auto diagonal() const -> X const&
+        {
+            return _x;
+        }
+
+        constexpr auto extents() const -> std::extents<std::size_t, N, N>
+        {
+            auto const n = ttl::extent<0>(_x);
+            return std::extents<std::size_t, N, N>(n, n);
+        }
+
+        constexpr auto operator[](std::size_t i, std::size_t j) const -> value_type
+        {
+            return (i == j) ? value_type(ttl::evaluate(_x, i)) : value_type {};
+        }
+
+        /// Tensor indexing.
+        constexpr auto operator()(this auto const& self, is_index auto... i)
+            -> decltype(ttl::bind(diagonal_matrix(self), ttl::index(i)...))
+        {
+            static_assert(sizeof...(i) == 2);
+            return ttl::bind(diagonal_matrix(self), ttl::index(i)...);
+        }
+    };
+
+    /// Bind a Kronecker delta with a static extent, e.g., delta<3>(i,j).
+    template <std::size_t N, class T = int>
+    inline constexpr auto delta(is_index auto i, is_index auto j)
+    {
+        return kronecker_delta<T, N>()(i, j);
+    }
+
+    /// Create a Kronecker delta with a dynamic extent, e.g., delta(n)(i,j).
+    template <class T = int>
+    inline constexpr auto delta(std::size_t n) -> kronecker_delta<T>
+    {
+        return kronecker_delta<T>(n);
+    }
+
+    /// Create a diagonal matrix from a rank-1 tensor, e.g., diagonal(x)(i,j).
+    template <tensor X>
+    inline constexpr auto diagonal(X&& x) -> diagonal_matrix<X>
+    {
+        return diagonal_matrix<X>(__fwd(x));
+    }
+}
@@ -0,0 +1,442 @@
+#pragma once
+
+#include <ttl/delta.hpp>
+#include <ttl/extents.hpp>
+#include <ttl/generator.hpp>
+#include <ttl/index_string.hpp>
+#include <ttl/math.hpp>
+#include <ttl/outer.hpp>
+#include <ttl/tensor.hpp>
+#include <ttl/tree/bind.hpp>
+#include <ttl/tree/function.hpp>
+#include <ttl/tree/negate.hpp>
+#include <ttl/tree/node.hpp>
+#include <ttl/tree/product.hpp>
+#include <ttl/tree/rewrite.hpp>
+#include <ttl/tree/sum.hpp>
+
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+/// Reverse mode differentiation of scalar expressions.
+///
+/// The adjoint of each node is built as an expression, starting from 1 at the
+/// root, and pushed down to the leaves with the chain rule, e.g., the adjoint
+/// of A in A(i,j) * B(j,k) * C(k,i) is B(j,k) * C(k,i). Each leaf that reads
+/// the tensor contributes its adjoint, renamed to the indices of the gradient,
+/// so the gradient is just another expression, and there is no tape.
+namespace ttl::tree::_
+{
+    /// The adjoint of the root of an expression, i.e., 1.
+    struct unit {
+    };
+
+    /// The gradient of a subtree that doesn't read the tensor.
+    struct no_gradient {
+    };
+
+    template <class T>
+    concept identity_prefix = requires(std::remove_cvref_t<T> const* t) {
+        []<class X>(unary_prefix<X, std::identity {}> const*) {}(t);
+    };
+
+    template <class T, auto op>
+    concept applies = requires {
+        requires std::same_as<std::remove_cvref_t<decltype(std::remove_cvref_t<T>::_op)>, std::remove_cvref_t<decltype(op)>>;
+    };
+
+    /// The sign of a number, the derivative of `math::abs`.
+    struct sign {
+        template <class T>
+        constexpr auto operator()(T const& x) const -> T
+        {
+            return T((T(0) < x) - (x < T(0)));
+        }
+    };
+
+    /// Check to see if `T` reads a tensor of type `X`.
+    template <class X, class T>
+    inline constexpr bool reads = [] {
+        using U = std::remove_cvref_t<T>;
+        if constexpr (is_leaf<U>) {
+            if constexpr (tree::is_bind<U>) {
+                return std::same_as<std::remove_cvref_t<typename tree::_::is_bind<U>::tensor_type>, X>;
+            }
+            else {
+                return false;
+            }
+        }
+        else if constexpr (binary<U>) {
+            return reads<X, child_a<U>> or reads<X, child_b<U>>;
+        }
+        else {
+            return reads<X, child_a<U>>;
+        }
+    }();
+
+    /// Check to see if a leaf of `t` reads the storage of the mdspan `x`
+    /// through another type, e.g., the strided view that a projection F(i,0)
+    /// is bound to (see `ttl::project`).
+    ///
+    /// During constant evaluation we can only compare addresses, so this
+    /// checks the first element of the leaf against each element of `x`.
+    template <class X>
+    inline constexpr bool reads_view(auto const& t, X const& x)
+    {
+        using U = std::remove_cvref_t<decltype(t)>;
+        if constexpr (is_leaf<U>) {
+            if constexpr (tree::is_bind<U>) {
+                using V = std::remove_cvref_t<typename tree::_::is_bind<U>::tensor_type>;
+                if constexpr (not std::same_as<V, X> and requires {
+                                  x.mapping().required_span_size();
+                                  requires std::same_as<decltype(t._a.data_handle()), decltype(x.data_handle())>;
+                                  requires std::is_pointer_v<std::remove_cvref_t<decltype(x.data_handle())>>;
+                              }) {
+                    auto const p = t._a.data_handle();
+                    auto const n = x.mapping().required_span_size();
+                    if consteval {
+                        for (std::size_t m = 0; m < n; ++m) {
+                            if (p == x.data_handle() + m) {
+                                return true;
+                            }
+                        }
+                        return false;
+                    }
+                    else {
+                        auto const a = reinterpret_cast<std::uintptr_t>(x.data_handle());
+                        auto const b = reinterpret_cast<std::uintptr_t>(p);
+                        return a <= b and b < a + n * sizeof(*p);
+                    }
+                }
+            }
+            return false;
+        }
+        else if constexpr (binary<U>) {
+            return reads_view(t._a, x) or reads_view(t._b, x);
+        }
+        else {
+            return reads_view(t._a, x);
+        }
+    }
+
+    /// The adjoint times `b`, contracting the indices that they share.
+    inline constexpr auto times(auto const& adj, auto const& b)
+    {
+        using Adj = std::remove_cvref_t<decltype(adj)>;
+        using B = std::remove_cvref_t<decltype(b)>;
+        if constexpr (std::same_as<Adj, unit>) {
+            return B(b);
+        }
+        else if constexpr (arithmetic<Adj> and arithmetic<B>) {
+            return adj * b;
+        }
+        else {
+            return multiply(Adj(adj), B(b));
+        }
+    }
+
+    /// The adjoint times `b` element-wise, where `b` has the same indices.
+    inline constexpr auto times_elementwise(auto const& adj, auto const& b)
+    {
+        using Adj = std::remove_cvref_t<decltype(adj)>;
+        using B = std::remove_cvref_t<decltype(b)>;
+        if constexpr (std::same_as<Adj, unit> or arithmetic<Adj>) {
+            return times(adj, b);
+        }
+        else {
+            return combine<std::multiplies {}>(Adj(adj), B(b));
+        }
+    }
+
+    /// The adjoint over `b` element-wise, where `b` has the same indices.
+    template <class S>
+    inline constexpr auto over_elementwise(auto const& adj, auto const& b)
+    {
+        using Adj = std::remove_cvref_t<decltype(adj)>;
+        using B = std::remove_cvref_t<decltype(b)>;
+        if constexpr (std::same_as<Adj, unit>) {
+            return product<S, B, std::divides {}, std::plus {}>(S(1), B(b));
+        }
+        else if constexpr (arithmetic<Adj>) {
+            return product<Adj, B, std::divides {}, std::plus {}>(adj, B(b));
+        }
+        else {
+            return combine<std::divides {}>(Adj(adj), B(b));
+        }
+    }
+
+    /// One over `b`, element-wise.
+    template <class S>
+    inline constexpr auto reciprocal(auto const& b)
+    {
+        using B = std::remove_cvref_t<decltype(b)>;
+        if constexpr (arithmetic<B>) {
+            return S(1) / S(b);
+        }
+        else {
+            return product<S, B, std::divides {}, std::plus {}>(S(1), B(b));
+        }
+    }
+
+    /// The square of the scalar `b`.
+    inline constexpr auto squared(auto const& b)
+    {
+        using B = std::remove_cvref_t<decltype(b)>;
+        if constexpr (arithmetic<B>) {
+            return b * b;
+        }
+        else {
+            return multiply(B(b), B(b));
+        }
+    }
+
+    inline constexpr auto negated(auto const& adj)
+    {
+        using Adj = std::remove_cvref_t<decltype(adj)>;
+        if constexpr (std::same_as<Adj, unit>) {
+            return -1;
+        }
+        else if constexpr (arithmetic<Adj>) {
+            return -adj;
+        }
+        else {
+            return unary_prefix<Adj, std::negate {}>(adj);
+        }
+    }
+
+    /// Rebind the adjoint `adj` of an expression with the indices `from` to
+    /// the indices `to`, slot by slot.
+    template <index_string from, index_string to>
+    inline constexpr auto renamed(auto const& adj)
+    {
+        using Adj = std::remove_cvref_t<decltype(adj)>;
+        if constexpr (std::same_as<Adj, unit> or arithmetic<Adj>) {
+            return adj;
+        }
+        else {
+            constexpr auto index = [] {
+                auto out = ttl::outer<Adj>;
+                for (std::size_t n = 0; n < out.size(); ++n) {
+                    out._data[n] = to[from.index_of(out[n])];
+                }
+                return out;
+            }();
+            if constexpr (index == ttl::outer<Adj>) {
+                return adj;
+            }
+            else {
+                return bind<Adj, index>(adj);
+            }
+        }
+    }
+
+    inline constexpr auto add_gradients(auto const& x, auto const& y)
+    {
+        using X = std::remove_cvref_t<decltype(x)>;
+        using Y = std::remove_cvref_t<decltype(y)>;
+        if constexpr (std::same_as<X, no_gradient>) {
+            return y;
+        }
+        else if constexpr (std::same_as<Y, no_gradient>) {
+            return x;
+        }
+        else {
+            return combine<std::plus {}>(x, y);
+        }
+    }
+
+    /// Multiply `g` by a delta for each of the contracted indices of `str`,
+    /// starting with the n-th, renamed to the indices `w`.
+    template <class S, index_string str, index_string w, std::size_t n = 0>
+    inline constexpr auto with_deltas(auto const& g, auto const& x)
+    {
+        constexpr auto contracted = str.contracted();
+        if constexpr (n == contracted.size()) {
+            return g;
+        }
+        else {
+            static constexpr auto s = str.find_offsets(contracted[n]);
+            constexpr auto index = [] {
+                index_string<3> out;
+                out._data[0] = w[s[0]];
+                out._data[1] = w[s[1]];
+                return out;
+            }();
+            auto const delta = bind<kronecker_delta<S>, index>(kronecker_delta<S>(ttl::extent(x, s[0])));
+            return with_deltas<S, str, w, n + 1>(times(g, delta), x);
+        }
+    }
+
+    /// Multiply `g` by an indicator for each of the projected slots of `str`,
+    /// starting with the s-th, e.g., delta(l,0) for the projected slot of
+    /// F(i,0), renamed to the indices `w`.
+    template <class S, index_string str, index_string w, std::size_t s = 0>
+    inline constexpr auto with_projections(auto const& g, auto const& t, auto const& x)
+    {
+        if constexpr (s == str.size()) {
+            return g;
+        }
+        else if constexpr (str[s] != projected_index) {
+            return with_projections<S, str, w, s + 1>(g, t, x);
+        }
+        else {
+            constexpr auto index = [] {
+                index_string<3> out;
+                out._data[0] = w[s];
+                out._data[1] = projected_index;
+                return out;
+            }();
+            ttl::index<index> id;
+            id._projected[1] = t._id[s];
+            auto const indicator = bind<kronecker_delta<S>, index>(kronecker_delta<S>(ttl::extent(x, s)), id);
+            return with_projections<S, str, w, s + 1>(times(g, indicator), t, x);
+        }
+    }
+
+    /// The contribution of the leaf `t` with the adjoint `adj` to the gradient
+    /// with respect to `x(w)`.
+    ///
+    /// Indices that the leaf contracts contribute a delta, e.g., the gradient
+    /// of A(i,i) is delta(k,l), and projected slots contribute an indicator,
+    /// e.g., the gradient of F(i,0) * x(i) is x(k) * delta(l,0). The leaf only
+    /// has the type of `x`, so the contribution is an `alternative` that is
+    /// zero if it reads another tensor.
+    template <class S, index_string w>
+    inline constexpr auto contribution(auto const& t, auto const& adj, auto const& x)
+    {
+        using T = std::remove_cvref_t<decltype(t)>;
+        constexpr auto str = tree::_::is_bind<T>::index;
+        auto const g = with_projections<S, str, w>(with_deltas<S, str, w>(renamed<str, w>(adj), x), t, x);
+        auto const zero = ttl::zeros<S>(ttl::extents(x));
+        return alternative(simplify(g), bind<decltype(zero), w>(zero), same_tensor(t._a, x));
+    }
+
+    /// Push the adjoint `adj` of `t` down to the leaves that read `x`, and sum
+    /// their contributions to the gradient with respect to `x(w)`.
+    template <class S, index_string w>
+    inline constexpr auto backprop(auto const& t, auto const& adj, auto const& x)
+    {
+        using T = std::remove_cvref_t<decltype(t)>;
+        using X = std::remove_cvref_t<decltype(x)>;
+        if constexpr (not reads<X, T>) {
+            return no_gradient {};
+        }
+        else if constexpr (is_leaf<T>) {
+            return contribution<S, w>(t, adj, x);
+        }
+        else if constexpr (tree::is_bind<T>) {
+            // A rebound expression, e.g., (A(i,k) * B(k,j))(j,i).
+            constexpr auto str = tree::_::is_bind<T>::index;
+            static_assert(str.outer().size() == str.size(), "Differentiation doesn't support contracted or projected expressions.");
+            return backprop<S, w>(t._a, renamed<str, ttl::outer<child_a<T>>>(adj), x);
+        }
+        else if constexpr (negation<T>) {
+            return backprop<S, w>(t._a, negated(adj), x);
+        }
+        else if constexpr (identity_prefix<T>) {
+            return backprop<S, w>(t._a, adj, x);
+        }
+        else if constexpr (applies<T, math::exp>) {
+            return backprop<S, w>(t._a, times_elementwise(adj, t), x);
+        }
+        else if constexpr (applies<T, math::log>) {
+            return backprop<S, w>(t._a, over_elementwise<S>(adj, t._a), x);
+        }
+        else if constexpr (applies<T, math::sqrt>) {
+            return backprop<S, w>(t._a, over_elementwise<S>(times(adj, S(0.5)), t), x);
+        }
+        else if constexpr (applies<T, math::abs>) {
+            using A = std::remove_cvref_t<child_a<T>>;
+            return backprop<S, w>(t._a, times_elementwise(adj, unary_function<A, sign {}>(t._a)), x);
+        }
+        else if constexpr (multiplicative<T>) {
+            // the adjoint of each operand is the adjoint times the other one
+            return add_gradients(backprop<S, w>(t._a, times(adj, t._b), x), backprop<S, w>(t._b, times(adj, t._a), x));
+        }
+        else if constexpr (requires { T::_reduce; } and applies<T, std::divides {}>) {
+            // a / b, where a or b is a scalar, e.g., A(i,j) / c, c / A(i,j) or
+            // A(i,j) / (x(k) * x(k)), has the derivatives 1 / b and -a / (b *
+            // b). The adjoint of the scalar operand sums over the other one.
+            using A = std::remove_cvref_t<child_a<T>>;
+            using B = std::remove_cvref_t<child_b<T>>;
+            auto const da = backprop<S, w>(t._a, times(adj, reciprocal<S>(t._b)), x);
+            if constexpr (rank<B> == 0) {
+                auto const bb = squared(t._b);
+                auto const q = product<A, decltype(bb), std::divides {}, std::plus {}>(t._a, bb);
+                return add_gradients(da, backprop<S, w>(t._b, times(negated(adj), q), x));
+            }
+            else {
+                auto const bb = combine<std::multiplies {}>(B(t._b), B(t._b));
+                auto const q = product<A, decltype(bb), std::divides {}, std::plus {}>(t._a, bb);
+                return add_gradients(da, backprop<S, w>(t._b, times_elementwise(negated(adj), q), x));
+            }
+        }
+        else if constexpr (requires { T::_reduce; } and applies<T, math::pow> and arithmetic<child_b<T>>) {
+            // pow(A(i,j), c) has the derivative c * pow(A(i,j), c - 1)
+            using A = std::remove_cvref_t<child_a<T>>;
+            using C = std::remove_cvref_t<child_b<T>>;
+            auto const d = multiply(C(t._b), product<A, C, math::pow, std::plus {}>(t._a, C(t._b - 1)));
+            return backprop<S, w>(t._a, times_elementwise(adj, d), x);
+        }
+        else if constexpr (sum_with<T, std::plus<>>) {
+            return add_gradients(backprop<S, w>(t._a, adj, x), backprop<S, w>(t._b, adj, x));
+        }
+        else if constexpr (sum_with<T, std::minus<>>) {
+            return add_gradients(backprop<S, w>(t._a, adj, x), backprop<S, w>(t._b, negated(adj), x));
+        }
+        else if constexpr (sum_with<T, std::multiplies<>>) {
+            return add_gradients(backprop<S, w>(t._a, times_elementwise(adj, t._b), x), backprop<S, w>(t._b, times_elementwise(adj, t._a), x));
+        }
+        else if constexpr (sum_with<T, std::divides<>>) {
+            // a / b has the derivatives 1 / b and -a / (b * b)
+            auto const bb = combine<std::multiplies {}>(std::remove_cvref_t<child_b<T>>(t._b), std::remove_cvref_t<child_b<T>>(t._b));
+            return add_gradients(backprop<S, w>(t._a, over_elementwise<S>(adj, t._b), x), backprop<S, w>(t._b, over_elementwise<S>(times_elementwise(negated(adj), t._a), bb), x));
+        }
+        else {
+            static_assert(false, "Differentiation doesn't support this expression.");
+        }
+    }
+}
+
+namespace ttl
+{
+    /// The gradient of the scalar expression `e` with respect to the tensor
+    /// bound in `x`, as an expression over the indices of `x`, e.g.,
+    ///
+    ///     auto W = 0.5 * F(i,j) * C(i,j,k,l) * F(k,l);
+    ///     dW(k,l) = grad(W, F(k,l));
+    ///
+    /// The gradient is built with reverse mode differentiation (see
+    /// `tree::_::backprop`), so it is evaluated by the same assignment kernels
+    /// as any other expression, without a tape or temporaries.
+    template <scalar E>
+    inline constexpr auto grad(E const& e, tree::is_bind auto const& x)
+    {
+        using X = std::remove_cvref_t<decltype(x)>;
+        using S = std::remove_cvref_t<scalar_type<E>>;
+        constexpr auto w = tree::_::is_bind<X>::index;
+        static_assert(w.size() != 0 and w.outer().size() == w.size(), "Differentiate with respect to a tensor bound to distinct indices, e.g., F(k,l).");
+
+        // A strided view of the tensor, e.g., the projection in F(i,0) * x(i),
+        // doesn't have its type, so its contribution can't be found.
+        if (tree::_::reads_view(e, x._a)) {
+            assert(false and "Differentiation doesn't support strided views of the tensor, e.g., F(i,0).");
+            std::abort();
+        }
+
+        auto const g = tree::_::backprop<S, w>(e, tree::_::unit {}, x._a);
+        if constexpr (std::same_as<decltype(g), tree::_::no_gradient const>) {
+            auto const zero = ttl::zeros<S>(ttl::extents(x._a));
+            return tree::bind<decltype(zero), w>(zero);
+        }
+        else {
+            return g;
+        }
+    }
+}
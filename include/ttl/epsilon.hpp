@@ -0,0 +1,68 @@
+#pragma once
+
+#include <ttl/bind.hpp>
+#include <ttl/index.hpp>
+
+#include <cstddef>
+#include <mdspan>
+#include <utility>
+
+namespace ttl
+{
+    /// The rank-N Levi-Civita permutation tensor in N dimensions.
+    ///
+    /// The value is the sign of (i...) as a permutation of (0,...,N-1), and
+    /// zero when any two indices are equal. Bound permutation tensors are
+    /// recognized by products (see `tree::levi_civita_bind`), so the
+    /// contractions in c(i) = epsilon(i,j,k) * a(j) * b(k) only visit the
+    /// nonzero permutations.
+    template <std::size_t N, class T = int>
+    struct levi_civita {
+        static_assert(N == 2 or N == 3, "The permutation tensor must have rank 2 or 3.");
+
+        using value_type = T;
+
+        static constexpr bool is_levi_civita = true;
+
+        static constexpr auto extents()
+        {
+            return []<std::size_t... n>(std::index_sequence<n...>) {
+                return std::extents<std::size_t, ((void)n, N)...>();
+            }(std::make_index_sequence<N>());
+        }
+
+        template <std::integral... I>
+            requires(sizeof...(I) == N)
+        constexpr auto operator[](I... i) const -> value_type
+        {
+            std::size_t const ind[] { std::size_t(i)... };
+            int sign = 1;
+            for (std::size_t a = 0; a < N; ++a) {
+                for (std::size_t b = a + 1; b < N; ++b) {
+                    if (ind[a] == ind[b]) {
+                        return value_type {};
+                    }
+                    if (ind[b] < ind[a]) {
+                        sign = -sign;
+                    }
+                }
+            }
+            return value_type(sign);
+        }
+
+        /// Tensor indexing.
+        constexpr auto operator()(this auto const& self, is_index auto... i)
+            -> decltype(ttl::bind(levi_civita(self), ttl::index(i)...))
+        {
+            static_assert(sizeof...(i) == N);
+            return ttl::bind(levi_civita(self), ttl::index(i)...);
+        }
+    };
+
+    /// Bind a Levi-Civita tensor, e.g., epsilon(i,j,k) or epsilon(i,j).
+    template <class T = int>
+    inline constexpr auto epsilon(is_index auto... i)
+    {
+        return levi_civita<sizeof...(i), T>()(i...);
+    }
+}
@@ -0,0 +1,579 @@
+#pragma once
+
+#include <ttl/evaluate.hpp>
+#include <ttl/extents.hpp>
+#include <ttl/index.hpp>
+#include <ttl/outer.hpp>
+#include <ttl/parallel.hpp>
+#include <ttl/tensor.hpp>
+#include <ttl/tree/assign.hpp>
+#include <ttl/tree/node.hpp>
+#include <ttl/tree/product.hpp>
+#include <ttl/tree/rewrite.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ttl
+{
+    namespace tree
+    {
+        namespace _
+        {
+            template <class S, class...>
+            inline constexpr auto first_space = S::_space;
+
+            /// Invoke `f(leaf, direct)` for each leaf of the expression `t`.
+            ///
+            /// The leaves are the bound tensors and the scalars. A leaf is
+            /// direct if the element that it reads at a point is selected by
+            /// its own index, rather than through a rebound expression or a
+            /// view of another tensor.
+            template <class T>
+            inline constexpr void for_each_leaf(T const& t, auto const& f, bool direct = true)
+            {
+                using U = std::remove_cvref_t<T>;
+                if constexpr (tree::is_bind<U>) {
+                    using X = typename tree::_::is_bind<U>::tensor_type;
+                    if constexpr (std::derived_from<X, node>) {
+                        for_each_leaf(t._a, f, false);
+                    }
+                    else {
+                        f(t, direct and not requires { t._a._x; });
+                    }
+                }
+                else if constexpr (not std::derived_from<U, node>) {
+                    f(t, direct);
+                }
+                else {
+                    if constexpr (requires { t._a; }) {
+                        for_each_leaf(t._a, f, direct);
+                    }
+                    if constexpr (requires { t._b; }) {
+                        for_each_leaf(t._b, f, direct);
+                    }
+                }
+            }
+
+            /// The tensor whose storage a leaf reads, looking through binds and
+            /// views.
+            inline constexpr auto storage(auto const& t) -> auto const&
+            {
+                if constexpr (tree::is_bind<decltype(t)>) {
+                    return storage(t._a);
+                }
+                else if constexpr (requires { t._x; }) {
+                    return storage(t._x);
+                }
+                else {
+                    return t;
+                }
+            }
+
+            /// Check to see if the `n` elements at `a` overlap the `m` elements
+            /// at `b`.
+            ///
+            /// During constant evaluation we can only compare the addresses.
+            template <class T, class U>
+            inline constexpr bool overlap(T const* a, std::size_t n, U const* b, std::size_t m)
+            {
+                if consteval {
+                    if constexpr (std::same_as<T, U>) {
+                        return a == b;
+                    }
+                    else {
+                        return false;
+                    }
+                }
+                else {
+                    auto const x = reinterpret_cast<std::uintptr_t>(a);
+                    auto const y = reinterpret_cast<std::uintptr_t>(b);
+                    return x < y + m * sizeof(U) and y < x + n * sizeof(T);
+                }
+            }
+
+            /// Check to see if two leaves might share storage.
+            ///
+            /// Mdspans over pointers and contiguous ranges compare the ranges
+            /// that they span, scalars compare their addresses, and everything
+            /// else falls back to `same_tensor`.
+            inline constexpr bool aliases(auto const& a, auto const& b)
+            {
+                auto const& x = storage(a);
+                auto const& y = storage(b);
+                using X = std::remove_cvref_t<decltype(x)>;
+                using Y = std::remove_cvref_t<decltype(y)>;
+                if constexpr (requires {
+                                  x.mapping().required_span_size();
+                                  y.mapping().required_span_size();
+                                  requires std::is_pointer_v<std::remove_cvref_t<decltype(x.data_handle())>>;
+                                  requires std::is_pointer_v<std::remove_cvref_t<decltype(y.data_handle())>>;
+                              }) {
+                    return overlap(x.data_handle(), x.mapping().required_span_size(), y.data_handle(), y.mapping().required_span_size());
+                }
+                else if constexpr (std::ranges::contiguous_range<X const> and std::ranges::sized_range<X const>
+                                   and std::ranges::contiguous_range<Y const> and std::ranges::sized_range<Y const>) {
+                    return overlap(std::ranges::data(x), std::ranges::size(x), std::ranges::data(y), std::ranges::size(y));
+                }
+                else if constexpr (std::is_arithmetic_v<X> and std::is_arithmetic_v<Y>) {
+                    return overlap(std::addressof(x), 1, std::addressof(y), 1);
+                }
+                else {
+                    return same_tensor(x, y);
+                }
+            }
+
+            /// Check to see if two direct leaves of the same storage select the
+            /// same element at every point.
+            inline constexpr bool same_element(auto const& a, auto const& b)
+            {
+                using A = std::remove_cvref_t<decltype(a)>;
+                using B = std::remove_cvref_t<decltype(b)>;
+                if constexpr (rank<A> == 0 and rank<B> == 0) {
+                    return true;
+                }
+                else if constexpr (tree::is_bind<A> and tree::is_bind<B>) {
+                    static constexpr auto x = tree::_::is_bind<A>::index;
+                    static constexpr auto y = tree::_::is_bind<B>::index;
+                    static constexpr bool same = x.count(projected_index) == 0 and std::ranges::equal(x, y);
+                    return same and same_tensor(a._a, b._a);
+                }
+                else {
+                    return false;
+                }
+            }
+
+            /// Check to see if the statement `q` can't be evaluated at the same
+            /// point as the earlier statement `p` without changing the result.
+            ///
+            /// That happens when either one reads the other's output, unless
+            /// the output is written element-wise and read at the element
+            /// written at that point, or when they write the same output.
+            template <class P, class Q>
+            inline constexpr bool conflict(P const& p, Q const& q)
+            {
+                bool out = false;
+                auto const check = [&](auto const& w, bool reduction, auto const& rhs) {
+                    for_each_leaf(w, [&](auto const& x, bool) {
+                        for_each_leaf(rhs, [&](auto const& y, bool direct) {
+                            if (aliases(x, y) and (reduction or not direct or not same_element(x, y))) {
+                                out = true;
+                            }
+                        });
+                    });
+                };
+                check(p._a, P::_reduction, q._b);
+                check(q._a, Q::_reduction, p._b);
+                for_each_leaf(p._a, [&](auto const& x, bool) {
+                    for_each_leaf(q._a, [&](auto const& y, bool) {
+                        out = out or aliases(x, y);
+                    });
+                });
+                return out;
+            }
+
+            /// Evaluate the statements [b, e) of `ss` in a single loop nest
+            /// over the iteration space `L` (see `ttl::assign_all`).
+            ///
+            /// Statements outside of [b, e) are skipped, and must be skipped if
+            /// their space isn't a permutation of `L`.
+            template <index_string L, class... S>
+            inline constexpr void fuse(std::tuple<S&...> ss, std::size_t b, std::size_t e)
+            {
+                static constexpr std::size_t N = L.size();
+
+                [&]<std::size_t... n>(std::index_sequence<n...>) {
+                    // Invoke f(s, n) for each statement `s` in [b, e).
+                    auto const each = [&](auto const& f) {
+                        ([&] {
+                            if constexpr (is_permutation(L, S::_space)) {
+                                if (b <= n and n < e) {
+                                    f(std::get<n>(ss), std::integral_constant<std::size_t, n>());
+                                }
+                            }
+                        }(), ...);
+                    };
+
+                    std::array<std::size_t, N> extents;
+                    extents.fill(std::dynamic_extent);
+                    each([&](auto& s, auto) {
+                        s.template _extents<L>(extents);
+                    });
+                    each([&](auto& s, auto) {
+                        s._seed();
+                    });
+
+                    std::size_t nt = 1;
+                    if constexpr (N != 0) {
+                        if !consteval {
+                            std::size_t size = 1;
+                            for (auto const x : extents) {
+                                size *= x;
+                            }
+                            nt = std::min(parallel_threads(size), extents[0]);
+                        }
+                    }
+
+                    auto partials = std::tuple { std::get<n>(ss).template _partials<L>((b <= n and n < e) ? nt : 0)... };
+
+                    parallel_for(nt, [&](std::size_t t) {
+                        std::array<std::size_t, N> lo {};
+                        auto hi = extents;
+                        if constexpr (N != 0) {
+                            lo[0] = extents[0] * t / nt;
+                            hi[0] = extents[0] * (t + 1) / nt;
+                        }
+                        auto const slices = std::tuple { std::get<n>(ss)._slice(std::get<n>(partials), t)... };
+                        for_each_box(lo, hi, [&](auto... i) {
+                            each([&](auto& s, auto m) {
+                                s.template _step<L>(std::get<m()>(slices), i...);
+                            });
+                        });
+                    });
+
+                    (std::get<n>(ss)._combine(std::get<n>(partials), nt), ...);
+                }(std::index_sequence_for<S...>());
+            }
+        }
+
+        /// An assignment, a = b, that has been recorded rather than executed
+        /// (see `ttl::assign_all`).
+        template <expression A, expression B>
+        struct statement {
+            static_assert(rank<A> == rank<B>);
+
+            using _type_b = std::remove_cvref_t<B>;
+            using _accumulator = accumulator_type<B>;
+
+            /// Check to see if the right hand side is a contraction, whose
+            /// terms are reduced directly into the left hand side.
+            static constexpr bool _reduction = requires {
+                requires _type_b::_outer_ab.contracted().size() != 0;
+                _type_b::_identity();
+                _type_b::_reduce;
+            };
+
+            static constexpr auto _outer = outer<A>;
+
+            /// The iteration space, i.e., the outer indices followed by any
+            /// contracted indices of a reduction.
+            static constexpr auto _space = [] {
+                if constexpr (_reduction) {
+                    return _type_b::_inner;
+                }
+                else {
+                    return outer<B>;
+                }
+            }();
+
+            static_assert(is_permutation(_outer, outer<B>));
+
+            /// Check to see if the statement can be evaluated one point at a
+            /// time, in a loop nest shared with other statements.
+            ///
+            /// Sparse and packed outputs (symmetric, triangular and Voigt)
+            /// don't store every element of the left hand side, so they're
+            /// left to `assign`.
+            static constexpr bool _pointwise = _::pointwise<A> and _::pointwise<B> and not sparse_bind<A> and not symmetric_bind<A>
+                and not triangular_output<A> and not voigt_bind<A>;
+
+            A _a;
+            B _b;
+
+            /// Execute the statement on its own, as an ordinary assignment.
+            constexpr void _execute()
+            {
+                assign(_a, _b);
+            }
+
+            /// Record the extent of each index of the iteration space `L` in
+            /// `e`, checking that it agrees with the extents already there.
+            template <index_string L>
+            constexpr void _extents(std::array<std::size_t, L.size()>& e) const
+            {
+                auto const record = [&](auto const& str, auto const& extents) {
+                    for (std::size_t n = 0; n < str.size(); ++n) {
+                        auto& x = e[L.index_of(str[n])];
+                        assert(x == std::dynamic_extent or x == extents.extent(n));
+                        x = extents.extent(n);
+                    }
+                };
+                record(_outer, ttl::extents(_a));
+                if constexpr (_reduction) {
+                    record(_space, _b._inner_extents());
+                }
+                else {
+                    record(outer<B>, ttl::extents(_b));
+                }
+            }
+
+            /// Seed the left hand side of a reduction with the identity.
+            constexpr void _seed()
+            {
+                if constexpr (_reduction) {
+                    _::for_each_index(ttl::extents(_a), [&](auto... i) {
+                        evaluate(_a, i...) = _type_b::_identity();
+                    });
+                }
+            }
+
+            /// Allocate a seeded partial result for each of `nt` threads, when
+            /// this is a reduction and the iteration space `L` is partitioned
+            /// along an index that the left hand side doesn't depend on.
+            template <index_string L>
+            constexpr auto _partials(std::size_t nt) const -> std::unique_ptr<_accumulator[]>
+            {
+                if constexpr (_reduction and _outer.count(L[0]) == 0) {
+                    if (nt > 1) {
+                        auto const n = nt * _size();
+                        auto p = std::make_unique<_accumulator[]>(n);
+                        std::fill_n(p.get(), n, _type_b::_identity());
+                        return p;
+                    }
+                }
+                return nullptr;
+            }
+
+            /// The partial result of thread `t`, if there is one.
+            constexpr auto _slice(std::unique_ptr<_accumulator[]> const& p, std::size_t t) const -> _accumulator*
+            {
+                return p ? p.get() + t * _size() : nullptr;
+            }
+
+            /// Evaluate the statement at the point i... of the iteration space
+            /// `L`.
+            ///
+            /// Reductions combine their term into `partial` if there is one,
+            /// and otherwise into the left hand side.
+            template <index_string L>
+            constexpr void _step(_accumulator* partial, std::integral auto... i)
+            {
+                static constexpr auto map_a = index_map<L, _outer>;
+                static constexpr auto map_b = [] {
+                    if constexpr (_reduction) {
+                        return index_map<L, _space>;
+                    }
+                    else {
+                        return index_map<L, outer<B>>;
+                    }
+                }();
+
+                [&]<std::size_t... a, std::size_t... b>(std::index_sequence<a...>, std::index_sequence<b...>) {
+                    std::size_t const ind[] { std::size_t(i)..., 0zu };
+                    if constexpr (_reduction) {
+                        auto const v = _b._term(ind[b]...);
+                        if (partial) {
+                            auto& y = partial[_offset(ind[a]...)];
+                            y = _type_b::_reduce(y, v);
+                        }
+                        else {
+                            auto&& y = evaluate(_a, ind[a]...);
+                            y = _type_b::_reduce(y, v);
+                        }
+                    }
+                    else {
+                        evaluate(_a, ind[a]...) = evaluate(_b, ind[b]...);
+                    }
+                }(map_a, map_b);
+            }
+
+            /// Combine the partial results of `nt` threads into the left hand
+            /// side.
+            constexpr void _combine(std::unique_ptr<_accumulator[]> const& p, std::size_t nt)
+            {
+                if constexpr (_reduction) {
+                    if (not p) {
+                        return;
+                    }
+                    auto const n = _size();
+                    _::for_each_index(ttl::extents(_a), [&](auto... i) {
+                        auto&& y = evaluate(_a, i...);
+                        auto const o = _offset(i...);
+                        for (std::size_t t = 0; t < nt; ++t) {
+                            y = _type_b::_reduce(y, p[t * n + o]);
+                        }
+                    });
+                }
+            }
+
+        private:
+            /// The number of elements of the left hand side.
+            constexpr auto _size() const -> std::size_t
+            {
+                auto const e = ttl::extents(_a);
+                std::size_t n = 1;
+                for (std::size_t r = 0; r < e.rank(); ++r) {
+                    n *= e.extent(r);
+                }
+                return n;
+            }
+
+            /// The row-major offset of the element i... of the left hand side
+            /// in a partial result.
+            constexpr auto _offset(std::integral auto... i) const -> std::size_t
+            {
+                auto const e = ttl::extents(_a);
+                std::size_t o = 0;
+                [&]<std::size_t... n>(std::index_sequence<n...>) {
+                    ((o = o * e.extent(n) + i), ...);
+                }(std::make_index_sequence<sizeof...(i)>());
+                return o;
+            }
+        };
+
+        /// An assignment target that records the assignment instead of
+        /// executing it (see `ttl::defer`).
+        template <expression A>
+        struct deferred {
+            A _a;
+
+            template <expression B>
+            constexpr auto operator=(this deferred&& self, B&& b) -> statement<A, B>
+            {
+                return statement<A, B>(__fwd(self._a), __fwd(b));
+            }
+        };
+
+        /// A recorded sequence of statements (see `ttl::record`).
+        template <class... S>
+        struct program {
+            std::tuple<S...> _statements;
+
+            /// Execute the statements, with the same results as executing them
+            /// one at a time, in order, up to rounding. The fused runs are
+            /// evaluated as written, without the rewrites of an ordinary
+            /// assignment (see `ttl::assign_all`).
+            ///
+            /// Each run of consecutive statements that share an iteration space
+            /// is evaluated in a single loop nest (see `ttl::assign_all`), so
+            /// that a chain like the one above makes one pass over memory. A
+            /// run is broken before a statement that reads an output of the
+            /// run other than at the element written at the same point (e.g.,
+            /// a transpose, or the result of a contraction), or that writes
+            /// something the run reads or writes. Statements that can't be
+            /// evaluated a point at a time (see `statement::_pointwise`) are
+            /// executed on their own.
+            ///
+            /// Intermediate results that aren't needed after the flush don't
+            /// need a tensor at all. Using the expression, e.g., auto t = a(i) +
+            /// b(i), evaluates it in registers in each statement that reads it.
+            constexpr void flush()
+            {
+                static constexpr std::size_t K = sizeof...(S);
+
+                [&]<std::size_t... n>(std::index_sequence<n...>) {
+                    auto ss = std::tie(std::get<n>(_statements)...);
+
+                    // Check each pair of statements for a shared iteration space
+                    // and for dependencies that prevent fusing them.
+                    bool const pointwise[] { S::_pointwise... };
+                    bool same[K][K] {};
+                    bool conflict[K][K] {};
+                    auto const row = [&]<std::size_t p>() {
+                        using P = std::tuple_element_t<p, std::tuple<S...>>;
+                        ((same[p][n] = is_permutation(P::_space, S::_space)), ...);
+                        ((conflict[p][n] = p < n and _::conflict(std::get<p>(ss), std::get<n>(ss))), ...);
+                    };
+                    (row.template operator()<n>(), ...);
+
+                    // Run the statements [b, e).
+                    auto const run = [&](std::size_t b, std::size_t e) {
+                        ([&] {
+                            if (n == b) {
+                                if (e - b == 1) {
+                                    std::get<n>(ss)._execute();
+                                }
+                                else {
+                                    _::fuse<S::_space>(ss, b, e);
+                                }
+                            }
+                        }(), ...);
+                    };
+
+                    std::size_t b = 0;
+                    for (std::size_t m = 1; m <= K; ++m) {
+                        bool joins = m < K and pointwise[b] and pointwise[m] and same[b][m];
+                        for (std::size_t p = b; joins and p < m; ++p) {
+                            joins = not conflict[p][m];
+                        }
+                        if (not joins) {
+                            run(b, m);
+                            b = m;
+                        }
+                    }
+                }(std::index_sequence_for<S...>());
+            }
+        };
+    }
+
+    /// Record an assignment to `a` instead of executing it, e.g.,
+    /// `ttl::defer(y(i)) = A(i,j) * x(j)`, so that it can be fused with other
+    /// assignments by `ttl::assign_all`.
+    template <expression A>
+    inline constexpr auto defer(A&& a) -> tree::deferred<A>
+    {
+        return tree::deferred<A>(__fwd(a));
+    }
+
+    /// Execute several recorded assignments in a single loop nest, e.g.,
+    ///
+    ///     ttl::assign_all(ttl::defer(y(i)) = A(i,j) * x(j),
+    ///                     ttl::defer(z(j)) = A(i,j) * w(i));
+    ///
+    /// reads A once rather than twice.
+    ///
+    /// The iteration space of an assignment is its outer indices, followed by
+    /// the contracted indices when the right hand side is a contraction, and
+    /// all of the statements must share the same space (in any order). We
+    /// visit the space once, in the order of the first statement, and at each
+    /// point evaluate each element-wise statement, or reduce the term of each
+    /// contraction into its left hand side. Other nested contractions are
+    /// evaluated element by element as usual.
+    ///
+    /// The space is partitioned across threads along its first index.
+    /// Reductions whose left hand side doesn't depend on that index (e.g., z
+    /// above) are accumulated per thread and combined at the end.
+    ///
+    /// The statements are evaluated as written. The algebraic rewrites and the
+    /// common subexpression elimination of an ordinary assignment (see
+    /// `TTL_REWRITE`) don't apply, so floating point results may differ from
+    /// `assign` in rounding, and repeated subexpressions are evaluated for
+    /// each statement.
+    ///
+    /// The left hand sides must not alias anything that the statements read.
+    template <tensor... A, tensor... B>
+    inline constexpr void assign_all(tree::statement<A, B>... s)
+    {
+        static_assert(sizeof...(s) != 0);
+        static constexpr auto L = tree::_::first_space<tree::statement<A, B>...>;
+        static_assert((is_permutation(L, tree::statement<A, B>::_space) and ...), "Fused assignments must share an iteration space.");
+        static_assert((tree::statement<A, B>::_pointwise and ...), "Scans, stencils, sparse and packed outputs can't be fused.");
+        tree::_::fuse<L>(std::tie(s...), 0, sizeof...(s));
+    }
+
+    /// Record a sequence of assignments, to be executed later by
+    /// `program::flush`, e.g., the stages of a time integrator
+    ///
+    ///     auto step = ttl::record(ttl::defer(t(i)) = a(i) + b(i),
+    ///                             ttl::defer(u(i)) = t(i) * dt,
+    ///                             ttl::defer(v(i)) = u(i) - c(i));
+    ///     step.flush();
+    ///
+    /// The statements keep references to their tensors (the binds of views
+    /// like tspan copy the view), so a program can be flushed repeatedly and
+    /// reads the current values each time.
+    template <tensor... A, tensor... B>
+    inline constexpr auto record(tree::statement<A, B>... s) -> tree::program<tree::statement<A, B>...>
+    {
+        return tree::program<tree::statement<A, B>...>(std::tuple<tree::statement<A, B>...>(std::move(s)...));
+    }
+}
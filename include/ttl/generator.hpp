@@ -0,0 +1,190 @@
+#pragma once
+
+#include <ttl/bind.hpp>
+#include <ttl/index.hpp>
+#include <ttl/tspan.hpp>
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <mdspan>
+#include <type_traits>
+#include <utility>
+
+namespace ttl
+{
+    /// A tensor whose elements are computed by a callable, `f(i...)`.
+    ///
+    /// Generators have no storage, so they can be used wherever a tensor is
+    /// only read, e.g., coordinate fields or weights, without allocating and
+    /// filling a buffer.
+    template <class F, std_extents Extents>
+    struct generator {
+        F _f;
+        Extents _extents;
+
+        constexpr auto extents() const -> Extents const&
+        {
+            return _extents;
+        }
+
+        template <std::integral... I>
+            requires(sizeof...(I) == Extents::rank())
+        constexpr auto operator[](I... i) const -> decltype(std::invoke(_f, std::size_t(i)...))
+        {
+            return std::invoke(_f, std::size_t(i)...);
+        }
+
+        /// Tensor indexing.
+        constexpr auto operator()(this auto const& self, is_index auto... i)
+            -> decltype(ttl::bind(generator(self), ttl::index(i)...))
+        {
+            static_assert(sizeof...(i) == Extents::rank());
+            return ttl::bind(generator(self), ttl::index(i)...);
+        }
+    };
+
+    /// A tensor whose elements all have the same value.
+    ///
+    /// Products recognize bound constants (see `tree::constant_bind`) and
+    /// multiply once by the value rather than once per term, e.g.,
+    /// A(i,j) * ones(j) is evaluated as the row sums of A.
+    template <class T, std_extents Extents>
+    struct constant_tensor {
+        using value_type = T;
+
+        static constexpr bool is_constant = true;
+
+        T _value;
+        Extents _extents;
+
+        constexpr auto value() const -> T const&
+        {
+            return _value;
+        }
+
+        constexpr auto extents() const -> Extents const&
+        {
+            return _extents;
+        }
+
+        template <std::integral... I>
+            requires(sizeof...(I) == Extents::rank())
+        constexpr auto operator[](I...) const -> T const&
+        {
+            return _value;
+        }
+
+        /// Tensor indexing.
+        constexpr auto operator()(this auto const& self, is_index auto... i)
+            -> decltype(ttl::bind(constant_tensor(self), ttl::index(i)...))
+        {
+            static_assert(sizeof...(i) == Extents::rank());
+            return ttl::bind(constant_tensor(self), ttl::index(i)...);
+        }
+    };
+
+    /// A tensor whose elements are all zero.
+    ///
+    /// Zeros are constants (see `constant_tensor`) that assignments also drop
+    /// from sums (see `tree::_::simplify`), e.g., C(i,j) = A(i,j) + Z(i,j)
+    /// assigns A(i,j).
+    template <class T, std_extents Extents>
+    struct zero_tensor {
+        using value_type = T;
+
+        static constexpr bool is_constant = true;
+        static constexpr bool is_zero = true;
+        static constexpr T _value {};
+
+        Extents _extents;
+
+        constexpr auto value() const -> T const&
+        {
+            return _value;
+        }
+
+        constexpr auto extents() const -> Extents const&
+        {
+            return _extents;
+        }
+
+        template <std::integral... I>
+            requires(sizeof...(I) == Extents::rank())
+        constexpr auto operator[](I...) const -> T const&
+        {
+            return _value;
+        }
+
+        /// Tensor indexing.
+        constexpr auto operator()(this auto const& self, is_index auto... i)
+            -> decltype(ttl::bind(zero_tensor(self), ttl::index(i)...))
+        {
+            static_assert(sizeof...(i) == Extents::rank());
+            return ttl::bind(zero_tensor(self), ttl::index(i)...);
+        }
+    };
+
+    namespace _
+    {
+        /// The row-major offset of (i...) in `extents`, plus `start`.
+        template <class T, std_extents Extents>
+        struct iota {
+            T start;
+            Extents extents;
+
+            constexpr auto operator()(std::integral auto... i) const -> T
+            {
+                std::size_t const ind[] { std::size_t(i)..., 0 };
+                std::size_t offset = 0;
+                for (std::size_t r = 0; r < Extents::rank(); ++r) {
+                    offset = offset * extents.extent(r) + ind[r];
+                }
+                return start + T(offset);
+            }
+        };
+    }
+
+    /// Create a constant tensor, e.g., fill(1, std::extents<std::size_t, 3>()).
+    template <class T, std_extents Extents>
+    inline constexpr auto fill(T value, Extents extents) -> constant_tensor<T, Extents>
+    {
+        return constant_tensor<T, Extents>(std::move(value), std::move(extents));
+    }
+
+    /// Create a constant tensor with dynamic extents, e.g., fill(1, n).
+    template <class T>
+    inline constexpr auto fill(T value, std::integral auto... n)
+    {
+        return ttl::fill(std::move(value), std::dextents<std::size_t, sizeof...(n)>(n...));
+    }
+
+    /// Create a zero tensor, e.g., zeros(std::extents<std::size_t, 3, 3>()).
+    template <class T = int, std_extents Extents>
+    inline constexpr auto zeros(Extents extents) -> zero_tensor<T, Extents>
+    {
+        return zero_tensor<T, Extents>(std::move(extents));
+    }
+
+    /// Create a zero tensor with dynamic extents, e.g., zeros<double>(n, n).
+    template <class T = int>
+    inline constexpr auto zeros(std::integral auto... n)
+    {
+        return ttl::zeros<T>(std::dextents<std::size_t, sizeof...(n)>(n...));
+    }
+
+    /// Create a tensor whose elements are their row-major offsets, plus
+    /// `start`.
+    template <class T = std::size_t, std_extents Extents>
+    inline constexpr auto iota(Extents extents, T start = T {})
+    {
+        return generator<_::iota<T, Extents>, Extents>(_::iota<T, Extents> { std::move(start), extents }, extents);
+    }
+
+    /// Create a tensor whose elements are computed by `f(i...)`.
+    template <class F, std_extents Extents>
+    inline constexpr auto generate(F f, Extents extents) -> generator<F, Extents>
+    {
+        return generator<F, Extents>(std::move(f), std::move(extents));
+    }
+}
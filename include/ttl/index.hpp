@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <concepts>
 #include <cstddef>
 #include <ranges>
 #include <utility>
@@ -62,6 +63,44 @@ namespace ttl
 
     index(std::size_t) -> index<index_string { "*" }>;
 
+    /// A single index with a constant offset, e.g., i + 1 or i - 1.
+    ///
+    /// Binding a tensor with offset indices binds a shifted view of it (see
+    /// `ttl::shift`), e.g., x(i+1) - 2 * x(i) + x(i-1).
+    template <index_string _str>
+    struct offset_index {
+        static_assert(_str.size() == 1 and _str[0] != projected_index, "Offsets apply to single free indices.");
+
+        std::ptrdiff_t _offset = 0;
+
+        constexpr auto offset() const -> std::ptrdiff_t
+        {
+            return _offset;
+        }
+
+        constexpr auto operator+(std::integral auto n) const -> offset_index
+        {
+            return { _offset + std::ptrdiff_t(n) };
+        }
+
+        constexpr auto operator-(std::integral auto n) const -> offset_index
+        {
+            return { _offset - std::ptrdiff_t(n) };
+        }
+    };
+
+    template <index_string str>
+    inline constexpr auto operator+(index<str> const&, std::integral auto n) -> offset_index<str>
+    {
+        return { std::ptrdiff_t(n) };
+    }
+
+    template <index_string str>
+    inline constexpr auto operator-(index<str> const&, std::integral auto n) -> offset_index<str>
+    {
+        return { -std::ptrdiff_t(n) };
+    }
+
     inline namespace literals
     {
         template <index_string i>
@@ -84,8 +123,23 @@ namespace ttl
         template <index_string str>
         struct is_index<index<str>> : std::true_type {
         };
+
+        template <index_string str>
+        struct is_index<offset_index<str>> : std::true_type {
+        };
+
+        template <class>
+        struct is_offset_index : std::false_type {
+        };
+
+        template <index_string str>
+        struct is_offset_index<offset_index<str>> : std::true_type {
+        };
     }
 
     template <class T>
     concept is_index = _::is_index<std::remove_cvref_t<T>>::value;
+
+    template <class T>
+    concept is_offset_index = _::is_offset_index<std::remove_cvref_t<T>>::value;
 }
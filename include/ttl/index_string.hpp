@@ -143,6 +143,16 @@ namespace ttl
             return out;
         }
 
+        /// Returns the index with the projected indices removed, in order.
+        constexpr auto unprojected() const -> index_string
+        {
+            index_string out;
+            std::ranges::copy_if(*this, out._data, [&](char const c) {
+                return c != projected_index;
+            });
+            return out;
+        }
+
         /// Returns outer() + contracted().
         constexpr auto inner() const -> index_string
         {
@@ -0,0 +1,617 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <mdspan>
+#include <type_traits>
+
+namespace ttl
+{
+    namespace _
+    {
+        /// The binomial coefficient `n` choose `k`.
+        inline constexpr auto binomial(std::size_t n, std::size_t k) -> std::size_t
+        {
+            if (k > n) {
+                return 0;
+            }
+            std::size_t out = 1;
+            for (std::size_t i = 1; i <= k; ++i) {
+                out = out * (n - k + i) / i;
+            }
+            return out;
+        }
+    }
+
+    /// A layout policy for packed, fully symmetric tensors.
+    ///
+    /// Only the elements with non-increasing indices are stored, in
+    /// lexicographic order, so a symmetric n x n matrix uses n(n+1)/2 elements
+    /// and a rank-r symmetric tensor uses (n+r-1 choose r). Every permutation
+    /// of an index maps to the same element, so the mapping is not unique.
+    struct layout_packed_symmetric {
+        template <class Extents>
+        struct mapping {
+            using extents_type = Extents;
+            using index_type = typename Extents::index_type;
+            using size_type = typename Extents::size_type;
+            using rank_type = typename Extents::rank_type;
+            using layout_type = layout_packed_symmetric;
+
+            static constexpr std::size_t _rank = Extents::rank();
+
+            extents_type _extents;
+
+            constexpr mapping() = default;
+
+            constexpr mapping(extents_type const& extents)
+                : _extents(extents)
+            {
+                for (rank_type r = 1; r < _rank; ++r) {
+                    assert(_extents.extent(r) == _extents.extent(0));
+                }
+            }
+
+            constexpr auto extents() const -> extents_type const&
+            {
+                return _extents;
+            }
+
+            constexpr auto required_span_size() const -> index_type
+            {
+                if constexpr (_rank == 0) {
+                    return 1;
+                }
+                else {
+                    return _::binomial(_extents.extent(0) + _rank - 1, _rank);
+                }
+            }
+
+            template <std::integral... I>
+                requires(sizeof...(I) == _rank)
+            constexpr auto operator()(I... i) const -> index_type
+            {
+                if constexpr (_rank == 0) {
+                    return 0;
+                }
+                else if constexpr (_rank == 1) {
+                    return index_type(i...);
+                }
+                else if constexpr (_rank == 2) {
+                    index_type const ind[] { index_type(i)... };
+                    auto const a = std::min(ind[0], ind[1]);
+                    auto const b = std::max(ind[0], ind[1]);
+                    return b * (b + 1) / 2 + a;
+                }
+                else {
+                    std::array<index_type, _rank> ind { index_type(i)... };
+                    std::ranges::sort(ind, std::greater {});
+                    index_type offset = 0;
+                    for (std::size_t k = 0; k < _rank; ++k) {
+                        offset += _::binomial(ind[k] + _rank - 1 - k, _rank - k);
+                    }
+                    return offset;
+                }
+            }
+
+            static constexpr bool is_always_unique()
+            {
+                return _rank < 2;
+            }
+
+            static constexpr bool is_always_exhaustive()
+            {
+                return true;
+            }
+
+            static constexpr bool is_always_strided()
+            {
+                return _rank < 2;
+            }
+
+            constexpr bool is_unique() const
+            {
+                return is_always_unique();
+            }
+
+            constexpr bool is_exhaustive() const
+            {
+                return true;
+            }
+
+            constexpr bool is_strided() const
+            {
+                return is_always_strided();
+            }
+
+            constexpr auto stride(rank_type) const -> index_type
+                requires(_rank < 2)
+            {
+                return 1;
+            }
+
+            friend constexpr bool operator==(mapping const& a, mapping const& b)
+            {
+                return a._extents == b._extents;
+            }
+        };
+    };
+
+    /// The stored half of a triangular matrix.
+    enum class triangle {
+        lower, ///< i >= j
+        upper, ///< i <= j
+    };
+
+    /// A layout policy for packed triangular matrices.
+    ///
+    /// The stored triangle uses n(n+1)/2 elements. Every element outside of
+    /// the triangle maps to one extra element at the end of the buffer, which
+    /// must hold zero. Every assignment to a triangular matrix, bound or not,
+    /// only writes the stored triangle, and products skip the zero half.
+    template <triangle _triangle>
+    struct layout_packed_triangular {
+        static constexpr triangle stored = _triangle;
+
+        template <class Extents>
+        struct mapping {
+            static_assert(Extents::rank() == 2);
+
+            using extents_type = Extents;
+            using index_type = typename Extents::index_type;
+            using size_type = typename Extents::size_type;
+            using rank_type = typename Extents::rank_type;
+            using layout_type = layout_packed_triangular;
+
+            extents_type _extents;
+
+            constexpr mapping() = default;
+
+            constexpr mapping(extents_type const& extents)
+                : _extents(extents)
+            {
+                assert(_extents.extent(0) == _extents.extent(1));
+            }
+
+            constexpr auto extents() const -> extents_type const&
+            {
+                return _extents;
+            }
+
+            constexpr auto required_span_size() const -> index_type
+            {
+                auto const n = _extents.extent(0);
+                return n * (n + 1) / 2 + 1;
+            }
+
+            /// Check to see if (i,j) is in the stored triangle.
+            static constexpr bool stores(index_type i, index_type j)
+            {
+                return (_triangle == triangle::lower) ? j <= i : i <= j;
+            }
+
+            constexpr auto operator()(std::integral auto i, std::integral auto j) const -> index_type
+            {
+                if (not stores(i, j)) {
+                    return required_span_size() - 1;
+                }
+                auto const a = std::min<index_type>(i, j);
+                auto const b = std::max<index_type>(i, j);
+                return b * (b + 1) / 2 + a;
+            }
+
+            static constexpr bool is_always_unique()
+            {
+                return false;
+            }
+
+            static constexpr bool is_always_exhaustive()
+            {
+                return true;
+            }
+
+            static constexpr bool is_always_strided()
+            {
+                return false;
+            }
+
+            constexpr bool is_unique() const
+            {
+                return false;
+            }
+
+            constexpr bool is_exhaustive() const
+            {
+                return true;
+            }
+
+            constexpr bool is_strided() const
+            {
+                return false;
+            }
+
+            friend constexpr bool operator==(mapping const& a, mapping const& b)
+            {
+                return a._extents == b._extents;
+            }
+        };
+    };
+
+    using layout_packed_lower = layout_packed_triangular<triangle::lower>;
+    using layout_packed_upper = layout_packed_triangular<triangle::upper>;
+
+    /// A layout policy for symmetric rank-2 tensors and minor-symmetric rank-4
+    /// tensors in Voigt form.
+    ///
+    /// A symmetric pair (i,j) of an n-dimensional index is stored as a single
+    /// Voigt index, with the n diagonal pairs first, followed by the
+    /// off-diagonal pairs in the usual order, e.g., 11, 22, 33, 23, 13, 12 in
+    /// three dimensions. Rank-2 tensors are stored as an m = n(n+1)/2 vector
+    /// and rank-4 tensors as an m x m matrix. When `_packed` is set the m x m
+    /// matrix is also assumed to be symmetric (i.e., the tensor has major
+    /// symmetry) and only its lower triangle is stored, e.g., the 21
+    /// independent elasticity coefficients in three dimensions.
+    ///
+    /// The stored values are the tensor components themselves, so any
+    /// Mandel or engineering-strain scaling is left to the contraction
+    /// kernels.
+    template <bool _packed>
+    struct layout_voigt_policy {
+        static constexpr bool packed = _packed;
+
+        /// The number of Voigt indices for an n-dimensional index.
+        static constexpr auto size(std::size_t n) -> std::size_t
+        {
+            return n * (n + 1) / 2;
+        }
+
+        /// The Voigt index of the pair (i,j).
+        static constexpr auto index(std::size_t n, std::size_t i, std::size_t j) -> std::size_t
+        {
+            if (i == j) {
+                return i;
+            }
+            auto const a = std::min(i, j);
+            auto const b = std::max(i, j);
+            return n + (n - 1) * n / 2 - b * (b + 1) / 2 + (b - 1 - a);
+        }
+
+        /// The pair (i,j), with i <= j, for the Voigt index `v`.
+        static constexpr auto pair(std::size_t n, std::size_t v) -> std::array<std::size_t, 2>
+        {
+            if (v < n) {
+                return { v, v };
+            }
+            v -= n;
+            std::size_t b = n - 1;
+            while (v >= b) {
+                v -= b;
+                b -= 1;
+            }
+            return { b - 1 - v, b };
+        }
+
+        template <class Extents>
+        struct mapping {
+            static_assert(Extents::rank() == 2 or Extents::rank() == 4);
+
+            using extents_type = Extents;
+            using index_type = typename Extents::index_type;
+            using size_type = typename Extents::size_type;
+            using rank_type = typename Extents::rank_type;
+            using layout_type = layout_voigt_policy;
+
+            static constexpr std::size_t _rank = Extents::rank();
+
+            extents_type _extents;
+
+            constexpr mapping() = default;
+
+            constexpr mapping(extents_type const& extents)
+                : _extents(extents)
+            {
+                for (rank_type r = 1; r < _rank; ++r) {
+                    assert(_extents.extent(r) == _extents.extent(0));
+                }
+            }
+
+            constexpr auto extents() const -> extents_type const&
+            {
+                return _extents;
+            }
+
+            constexpr auto required_span_size() const -> index_type
+            {
+                auto const m = size(_extents.extent(0));
+                if constexpr (_rank == 2) {
+                    return m;
+                }
+                else if constexpr (_packed) {
+                    return m * (m + 1) / 2;
+                }
+                else {
+                    return m * m;
+                }
+            }
+
+            template <std::integral... I>
+                requires(sizeof...(I) == _rank)
+            constexpr auto operator()(I... i) const -> index_type
+            {
+                auto const n = _extents.extent(0);
+                std::size_t const ind[] { std::size_t(i)... };
+                if constexpr (_rank == 2) {
+                    return index(n, ind[0], ind[1]);
+                }
+                else {
+                    auto const v = index(n, ind[0], ind[1]);
+                    auto const w = index(n, ind[2], ind[3]);
+                    if constexpr (_packed) {
+                        auto const a = std::min(v, w);
+                        auto const b = std::max(v, w);
+                        return b * (b + 1) / 2 + a;
+                    }
+                    else {
+                        return v * size(n) + w;
+                    }
+                }
+            }
+
+            static constexpr bool is_always_unique()
+            {
+                return false;
+            }
+
+            static constexpr bool is_always_exhaustive()
+            {
+                return true;
+            }
+
+            static constexpr bool is_always_strided()
+            {
+                return false;
+            }
+
+            constexpr bool is_unique() const
+            {
+                return false;
+            }
+
+            constexpr bool is_exhaustive() const
+            {
+                return true;
+            }
+
+            constexpr bool is_strided() const
+            {
+                return false;
+            }
+
+            friend constexpr bool operator==(mapping const& a, mapping const& b)
+            {
+                return a._extents == b._extents;
+            }
+        };
+    };
+
+    using layout_voigt = layout_voigt_policy<false>;
+    using layout_voigt_packed = layout_voigt_policy<true>;
+
+    /// A layout policy for matrices stored as a row-major grid of row-major
+    /// `_rows` x `_cols` tiles.
+    ///
+    /// The extents are padded up to whole tiles. The assignment engine visits
+    /// rank-2 expressions that read or write a tiled matrix one tile at a
+    /// time (see `tiled`), so both A(i,j) and A(j,i) stay in cache when the
+    /// tiles are square.
+    template <std::size_t _rows, std::size_t _cols = _rows>
+    struct layout_tiled {
+        static_assert(_rows != 0 and _cols != 0);
+
+        /// The natural loop blocking for this layout.
+        static constexpr std::array<std::size_t, 2> tile { _rows, _cols };
+
+        template <class Extents>
+        struct mapping {
+            static_assert(Extents::rank() == 2);
+
+            using extents_type = Extents;
+            using index_type = typename Extents::index_type;
+            using size_type = typename Extents::size_type;
+            using rank_type = typename Extents::rank_type;
+            using layout_type = layout_tiled;
+
+            extents_type _extents;
+
+            constexpr mapping() = default;
+
+            constexpr mapping(extents_type const& extents)
+                : _extents(extents)
+            {
+            }
+
+            constexpr auto extents() const -> extents_type const&
+            {
+                return _extents;
+            }
+
+            /// The number of tiles in each column of tiles.
+            constexpr auto _tiles() const -> index_type
+            {
+                return (_extents.extent(1) + _cols - 1) / _cols;
+            }
+
+            constexpr auto required_span_size() const -> index_type
+            {
+                auto const m = (_extents.extent(0) + _rows - 1) / _rows;
+                return m * _tiles() * _rows * _cols;
+            }
+
+            constexpr auto operator()(std::integral auto i, std::integral auto j) const -> index_type
+            {
+                index_type const t = (index_type(i) / _rows) * _tiles() + index_type(j) / _cols;
+                return t * (_rows * _cols) + (index_type(i) % _rows) * _cols + index_type(j) % _cols;
+            }
+
+            static constexpr bool is_always_unique()
+            {
+                return true;
+            }
+
+            static constexpr bool is_always_exhaustive()
+            {
+                return false;
+            }
+
+            static constexpr bool is_always_strided()
+            {
+                return false;
+            }
+
+            constexpr bool is_unique() const
+            {
+                return true;
+            }
+
+            constexpr bool is_exhaustive() const
+            {
+                return _extents.extent(0) % _rows == 0 and _extents.extent(1) % _cols == 0;
+            }
+
+            constexpr bool is_strided() const
+            {
+                return false;
+            }
+
+            friend constexpr bool operator==(mapping const& a, mapping const& b)
+            {
+                return a._extents == b._extents;
+            }
+        };
+    };
+
+    /// A layout policy for matrices stored in Morton (Z-curve) order.
+    ///
+    /// The bits of i and j are interleaved, so every aligned power-of-two
+    /// square block is contiguous at every scale. The extents are padded up
+    /// to a power-of-two square.
+    struct layout_morton {
+        /// The natural loop blocking for this layout.
+        static constexpr std::array<std::size_t, 2> tile { 16, 16 };
+
+        /// Spread the bits of `x` out to the even bit positions.
+        static constexpr auto spread(std::uint64_t x) -> std::uint64_t
+        {
+            x &= 0xFFFFFFFF;
+            x = (x | (x << 16)) & 0x0000FFFF0000FFFF;
+            x = (x | (x << 8)) & 0x00FF00FF00FF00FF;
+            x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0F;
+            x = (x | (x << 2)) & 0x3333333333333333;
+            x = (x | (x << 1)) & 0x5555555555555555;
+            return x;
+        }
+
+        template <class Extents>
+        struct mapping {
+            static_assert(Extents::rank() == 2);
+
+            using extents_type = Extents;
+            using index_type = typename Extents::index_type;
+            using size_type = typename Extents::size_type;
+            using rank_type = typename Extents::rank_type;
+            using layout_type = layout_morton;
+
+            extents_type _extents;
+
+            constexpr mapping() = default;
+
+            constexpr mapping(extents_type const& extents)
+                : _extents(extents)
+            {
+            }
+
+            constexpr auto extents() const -> extents_type const&
+            {
+                return _extents;
+            }
+
+            constexpr auto required_span_size() const -> index_type
+            {
+                auto const n = std::bit_ceil(std::size_t(std::max(_extents.extent(0), _extents.extent(1))));
+                return n * n;
+            }
+
+            constexpr auto operator()(std::integral auto i, std::integral auto j) const -> index_type
+            {
+                return index_type((spread(std::uint64_t(i)) << 1) | spread(std::uint64_t(j)));
+            }
+
+            static constexpr bool is_always_unique()
+            {
+                return true;
+            }
+
+            static constexpr bool is_always_exhaustive()
+            {
+                return false;
+            }
+
+            static constexpr bool is_always_strided()
+            {
+                return false;
+            }
+
+            constexpr bool is_unique() const
+            {
+                return true;
+            }
+
+            constexpr bool is_exhaustive() const
+            {
+                return required_span_size() == _extents.extent(0) * _extents.extent(1);
+            }
+
+            constexpr bool is_strided() const
+            {
+                return false;
+            }
+
+            friend constexpr bool operator==(mapping const& a, mapping const& b)
+            {
+                return a._extents == b._extents;
+            }
+        };
+    };
+
+    /// An mdspan with packed symmetric storage.
+    template <class T>
+    concept packed_symmetric = requires {
+        requires std::same_as<typename std::remove_cvref_t<T>::layout_type, layout_packed_symmetric>;
+    };
+
+    /// An mdspan with packed triangular storage.
+    template <class T>
+    concept packed_triangular = requires {
+        requires std::same_as<typename std::remove_cvref_t<T>::layout_type, layout_packed_lower>
+            or std::same_as<typename std::remove_cvref_t<T>::layout_type, layout_packed_upper>;
+    };
+
+    /// An mdspan whose layout has a natural loop blocking, e.g.,
+    /// `layout_tiled` or `layout_morton`.
+    template <class T>
+    concept tiled = requires {
+        { std::remove_cvref_t<T>::layout_type::tile } -> std::convertible_to<std::array<std::size_t, 2>>;
+    };
+
+    /// An mdspan with Voigt storage.
+    template <class T>
+    concept voigt = requires {
+        requires std::same_as<typename std::remove_cvref_t<T>::layout_type, layout_voigt>
+            or std::same_as<typename std::remove_cvref_t<T>::layout_type, layout_voigt_packed>;
+    };
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <ttl/tensor.hpp>
+#include <ttl/tree/execution_traits.hpp>
+
+namespace ttl
+{
+    namespace tree
+    {
+        /// An assignment target that only writes where a mask is nonzero (see
+        /// `ttl::masked`).
+        template <tensor A, tensor M>
+        struct masked {
+            A _a;
+            M _m;
+
+            constexpr void operator=(this masked&& self, tensor auto&& b)
+            {
+                execution_traits<A, decltype(b)>::assign_masked(__fwd(self._a), self._m, __fwd(b));
+            }
+        };
+    }
+
+    /// Select the elements of `a` to assign using the mask `m`, e.g.,
+    /// `ttl::masked(C(i,j), M(i,j)) = A(i,k) * B(k,j)`.
+    ///
+    /// Only the selected elements of the right hand side are evaluated. The
+    /// mask can be any tensor with the same shape, in which case nonzero
+    /// elements are selected, or a bound sparse matrix, in which case its
+    /// stored entries are selected.
+    template <tensor A, tensor M>
+    inline constexpr auto masked(A&& a, M&& m) -> tree::masked<A, M>
+    {
+        return tree::masked<A, M>(__fwd(a), __fwd(m));
+    }
+}
@@ -0,0 +1,402 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+/// By default the element-wise math functions use the branch-free polynomial
+/// kernels below, which the compiler can vectorize along with the rest of an
+/// assignment loop (GCC also needs -fno-trapping-math, which is clang's
+/// default). Define this to call the standard library instead, e.g., to check
+/// results against correctly rounded values. Constant evaluation always uses
+/// the kernels.
+#ifndef TTL_EXACT_MATH
+#define TTL_EXACT_MATH 0
+#endif
+
+/// Double precision pow calls std::pow at run time, because the error of the
+/// exp(y log(x)) kernel grows with |y log(x)|. Define this to use the kernel
+/// anyway, e.g., to vectorize an assignment loop that raises doubles to
+/// non-integral powers.
+#ifndef TTL_FAST_POW
+#define TTL_FAST_POW 0
+#endif
+
+namespace ttl::math
+{
+    namespace _
+    {
+        /// The floating point types that have kernels.
+        template <class T>
+        concept kernel_type = std::same_as<T, float> or std::same_as<T, double>;
+
+        /// The unsigned integer with the same representation as T.
+        template <kernel_type T>
+        using bits_type = std::conditional_t<std::same_as<T, float>, std::uint32_t, std::uint64_t>;
+
+        template <kernel_type T>
+        inline constexpr int mantissa_bits = std::numeric_limits<T>::digits - 1;
+
+        template <kernel_type T>
+        inline constexpr int exponent_bias = std::numeric_limits<T>::max_exponent - 1;
+
+        /// 2^k for k in the normal exponent range.
+        template <kernel_type T>
+        inline constexpr auto exp2i(int k) -> T
+        {
+            return std::bit_cast<T>(bits_type<T>(k + exponent_bias<T>) << mantissa_bits<T>);
+        }
+
+        /// Split ln(2) into a high part with enough trailing zeros that k *
+        /// hi is exact for every k we use, and the rounding error of hi.
+        template <kernel_type T>
+        inline constexpr T ln2_hi = std::same_as<T, float> ? T(0x1.62e4p-1) : T(0x1.62e42feep-1);
+
+        template <kernel_type T>
+        inline constexpr T ln2_lo = std::same_as<T, float> ? T(0x1.7f7d1cp-20) : T(0x1.a39ef35793c76p-33);
+
+        /// The number of Taylor terms for exp(r) with |r| <= ln(2)/2, and
+        /// atanh(s)/s with |s| <= 3 - 2 sqrt(2), that bring the truncation
+        /// error well below half an ulp.
+        template <kernel_type T>
+        inline constexpr int exp_terms = std::same_as<T, float> ? 8 : 14;
+
+        template <kernel_type T>
+        inline constexpr int log_terms = std::same_as<T, float> ? 5 : 11;
+
+        /// Evaluate c[0] + c[1] x + ... + c[N-1] x^(N-1) by Horner's rule,
+        /// unrolled so that callers stay free of control flow.
+        template <class T, std::size_t N>
+        inline constexpr auto horner(std::array<T, N> const& c, T x) -> T
+        {
+            return [&]<std::size_t... n>(std::index_sequence<n...>) {
+                T p = c[N - 1];
+                ((p = p * x + c[N - 2 - n]), ...);
+                return p;
+            }(std::make_index_sequence<N - 1>());
+        }
+
+        template <kernel_type T, int N>
+        inline constexpr auto exp_coefficients = [] {
+            // c[n] = 1/n!
+            std::array<T, N> c {};
+            double f = 1;
+            for (int n = 0; n < N; ++n) {
+                c[n] = T(1 / f);
+                f *= n + 1;
+            }
+            return c;
+        }();
+
+        template <kernel_type T, int N>
+        inline constexpr auto log_coefficients = [] {
+            // c[n] = 1/(2n + 3)
+            std::array<T, N> c {};
+            for (int n = 0; n < N; ++n) {
+                c[n] = T(1.0 / (2 * n + 3));
+            }
+            return c;
+        }();
+
+        /// exp(x) for finite x, using x = k ln(2) + r, |r| <= ln(2)/2, and a
+        /// Taylor polynomial for exp(r).
+        ///
+        /// The result is within 1 ulp of exp(x) for normal results (for
+        /// subnormal results the final scaling rounds twice). Special values
+        /// are selected at the end rather than branched on, so that loops over
+        /// this can be vectorized.
+        template <kernel_type T>
+        inline constexpr auto exp(T x) -> T
+        {
+            constexpr T max = std::same_as<T, float> ? T(0x1.62e42ep+6) : T(0x1.62e42fefa39efp+9);
+            constexpr T min = std::same_as<T, float> ? T(-0x1.9fe368p+6) : T(-0x1.74910d52d3051p+9);
+
+            // Keep k in range, even for NaN and infinite x. The selects are
+            // written as separate statements, which compilers if-convert more
+            // reliably than nested conditionals.
+            T xc = (x < min) ? min : x;
+            xc = (xc > max) ? max : xc;
+            xc = (x == x) ? xc : T(0);
+
+            constexpr T log2e = T(1.4426950408889634074);
+            T const y = xc * log2e;
+            // Round to the nearest integer by pushing the fraction out of the
+            // mantissa.
+            constexpr T shifter = T(1.5) * exp2i<T>(mantissa_bits<T>);
+            T const kf = (y + shifter) - shifter;
+            int const k = int(kf);
+            T const r = (xc - kf * ln2_hi<T>) - kf * ln2_lo<T>;
+
+            T const p = horner(exp_coefficients<T, exp_terms<T>>, r);
+
+            // Scale in two steps so that neither factor leaves the normal range.
+            int const h = k / 2;
+            T z = p * exp2i<T>(h) * exp2i<T>(k - h);
+            z = (x > max) ? std::numeric_limits<T>::infinity() : z;
+            z = (x < min) ? T(0) : z;
+            return (x == x) ? z : x;
+        }
+
+        /// log(x), using x = 2^e m, sqrt(1/2) <= m < sqrt(2), and
+        /// log(m) = 2 atanh(s) with s = (m - 1)/(m + 1).
+        ///
+        /// The result is within 1 ulp of log(x). As with exp, special values
+        /// are selected at the end.
+        template <kernel_type T>
+        inline constexpr auto log(T x) -> T
+        {
+            // Scale subnormals into the normal range.
+            constexpr int shift = mantissa_bits<T> + 2;
+            bool const subnormal = x < std::numeric_limits<T>::min();
+            T const xs = subnormal ? x * exp2i<T>(shift) : x;
+
+            using U = bits_type<T>;
+            constexpr U mantissa = (U(1) << mantissa_bits<T>) - 1;
+            constexpr U sign = U(1) << (sizeof(U) * 8 - 1);
+            U const bits = std::bit_cast<U>(xs) & ~sign;
+            int e = int(bits >> mantissa_bits<T>) - exponent_bias<T>;
+            e = subnormal ? e - shift : e;
+            T m = std::bit_cast<T>((bits & mantissa) | (U(exponent_bias<T>) << mantissa_bits<T>));
+            bool const high = m > T(1.41421356237309504880);
+            m = high ? m * T(0.5) : m;
+            e = high ? e + 1 : e;
+
+            T const f = m - 1;
+            T const s = f / (2 + f);
+            T const s2 = s * s;
+
+            T const p = horner(log_coefficients<T, log_terms<T>>, s2);
+
+            // log(m) = 2s + 2s s^2 p and 2s = f - s f, which keeps the
+            // dominant term f exact.
+            T const log_m = f - s * (f - 2 * s2 * p);
+            T z = T(e) * ln2_hi<T> + (log_m + T(e) * ln2_lo<T>);
+            z = (x == std::numeric_limits<T>::infinity()) ? x : z;
+            z = (x == 0) ? -std::numeric_limits<T>::infinity() : z;
+            z = (x < 0) ? std::numeric_limits<T>::quiet_NaN() : z;
+            return (x == x) ? z : x;
+        }
+
+        /// sqrt(x) by Newton's method, for constant evaluation.
+        template <kernel_type T>
+        inline constexpr auto sqrt(T x) -> T
+        {
+            if (x != x or x == 0 or x == std::numeric_limits<T>::infinity()) {
+                return x;
+            }
+            if (x < 0) {
+                return std::numeric_limits<T>::quiet_NaN();
+            }
+            // Any positive guess is above the root after one step, and the
+            // iterates then decrease until they converge.
+            T y = T(0.5) * (x + 1);
+            for (T z = T(0.5) * (y + x / y); z < y; z = T(0.5) * (y + x / y)) {
+                y = z;
+            }
+            return y;
+        }
+
+        /// An integral exponent, i.e., any integer other than bool.
+        template <class T>
+        concept integral_exponent = std::integral<T> and not std::same_as<std::remove_cv_t<T>, bool>;
+
+        template <class T>
+        inline constexpr auto integral_power(T x, integral_exponent auto n) -> T
+        {
+            bool const invert = n < 0;
+            auto m = std::make_unsigned_t<decltype(n)>(invert ? -(n + 1) : n) + unsigned(invert);
+            T y = T(1);
+            for (; m != 0; m >>= 1) {
+                if (m & 1) {
+                    y *= x;
+                }
+                x *= x;
+            }
+            return invert ? T(1) / y : y;
+        }
+
+        /// The floating point type used for a function of T, following the
+        /// standard library (integers are computed as double).
+        template <class T>
+        using float_type = std::conditional_t<std::floating_point<T>, T, double>;
+    }
+
+    /// e^x.
+    inline constexpr struct exp_fn {
+        template <class T>
+        static constexpr auto operator()(T x) -> _::float_type<T>
+        {
+            using F = _::float_type<T>;
+            if constexpr (_::kernel_type<F>) {
+                if consteval {
+                    return _::exp(F(x));
+                }
+                else {
+                    if constexpr (TTL_EXACT_MATH) {
+                        return std::exp(F(x));
+                    }
+                    else {
+                        return _::exp(F(x));
+                    }
+                }
+            }
+            else {
+                return std::exp(F(x));
+            }
+        }
+    } exp;
+
+    /// The natural logarithm.
+    inline constexpr struct log_fn {
+        template <class T>
+        static constexpr auto operator()(T x) -> _::float_type<T>
+        {
+            using F = _::float_type<T>;
+            if constexpr (_::kernel_type<F>) {
+                if consteval {
+                    return _::log(F(x));
+                }
+                else {
+                    if constexpr (TTL_EXACT_MATH) {
+                        return std::log(F(x));
+                    }
+                    else {
+                        return _::log(F(x));
+                    }
+                }
+            }
+            else {
+                return std::log(F(x));
+            }
+        }
+    } log;
+
+    /// The square root. At run time this is always std::sqrt, which is
+    /// correctly rounded and compiles to a (vectorizable) instruction.
+    inline constexpr struct sqrt_fn {
+        template <class T>
+        static constexpr auto operator()(T x) -> _::float_type<T>
+        {
+            using F = _::float_type<T>;
+            if constexpr (_::kernel_type<F>) {
+                if consteval {
+                    return _::sqrt(F(x));
+                }
+            }
+            return std::sqrt(F(x));
+        }
+    } sqrt;
+
+    /// The absolute value, without a branch.
+    inline constexpr struct abs_fn {
+        template <class T>
+        static constexpr auto operator()(T x) -> T
+        {
+            if constexpr (std::unsigned_integral<T>) {
+                return x;
+            }
+            else {
+                // Written so that abs(-0.0) is +0.0 and NaNs pass through.
+                return (x < T(0)) ? T(-x) : (x == T(0)) ? T(0) : x;
+            }
+        }
+    } abs;
+
+    /// x^y.
+    ///
+    /// Integral exponents are computed by repeated squaring, so pow(x, 2) is
+    /// x * x for any x, including integers. Otherwise float results are
+    /// exp(y log(x)) computed in double, which is within 1 ulp, and double
+    /// results call std::pow at run time (see TTL_FAST_POW). Constant
+    /// evaluation uses the kernel, which squares small integral floating point
+    /// exponents too, so pow(3.0, 2.0) is 9, and whose error otherwise grows
+    /// with |y log(x)| (by about that many ulp). Zeros, infinities and NaNs
+    /// give the same results as std::pow, and bool exponents are treated as
+    /// floating point.
+    inline constexpr struct pow_fn {
+        template <class T, class U>
+        static constexpr auto operator()(T x, U y)
+        {
+            if constexpr (_::integral_exponent<U>) {
+                if constexpr (std::integral<T>) {
+                    assert(y >= 0);
+                }
+                return _::integral_power(x, y);
+            }
+            else {
+                using F = std::common_type_t<_::float_type<T>, U>;
+                if constexpr (std::same_as<F, float> and not TTL_EXACT_MATH) {
+                    return F(_pow(double(x), double(y)));
+                }
+                else if constexpr (std::same_as<F, double> and TTL_FAST_POW and not TTL_EXACT_MATH) {
+                    return _pow(double(x), double(y));
+                }
+                else {
+                    if consteval {
+                        if constexpr (_::kernel_type<F>) {
+                            return F(_pow(double(x), double(y)));
+                        }
+                    }
+                    return std::pow(F(x), F(y));
+                }
+            }
+        }
+
+    private:
+        /// x^y, with the special cases of std::pow.
+        template <class F>
+        static constexpr auto _pow(F x, F y) -> F
+        {
+            constexpr F inf = std::numeric_limits<F>::infinity();
+            if (y == 0 or x == 1) {
+                return F(1);
+            }
+            if (x != x or y != y) {
+                return (x != x) ? x : y;
+            }
+
+            // Every floating point value from 2^digits up is an even integer.
+            constexpr F even = _::exp2i<F>(std::numeric_limits<F>::digits);
+            F const a = (y < 0) ? -y : y;
+            bool const integral = not (a < even) or F(std::int64_t(y)) == y;
+            bool const odd = a < even and integral and (std::int64_t(y) & 1);
+
+            if (x == 0) {
+                F const z = (y < 0) ? inf : F(0);
+                bool const negative = std::bit_cast<_::bits_type<F>>(x) >> (sizeof(F) * 8 - 1);
+                return (odd and negative) ? -z : z;
+            }
+            if (a == inf) {
+                if (x == -1) {
+                    return F(1);
+                }
+                return (((x < 0) ? -x : x) < 1) == (y < 0) ? inf : F(0);
+            }
+            if (x == -inf) {
+                F const z = (y < 0) ? F(0) : inf;
+                return odd ? -z : z;
+            }
+            // Small integral exponents are squared, which is exact whenever the
+            // result is representable, e.g., pow(10.0, 22.0).
+            if (integral and a <= 64) {
+                return _::integral_power(x, int(y));
+            }
+            if (x < 0) {
+                // Negative bases only have real powers for integral exponents.
+                if (not integral) {
+                    return std::numeric_limits<F>::quiet_NaN();
+                }
+                F const z = _::exp(y * _::log(-x));
+                return odd ? -z : z;
+            }
+            return _::exp(y * _::log(x));
+        }
+    } pow;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/// Parallel kernels give each thread at least this many units of work (e.g.,
+/// nonzeros), so that small problems don't pay for thread startup.
+#ifndef TTL_PARALLEL_GRAIN
+#define TTL_PARALLEL_GRAIN (1zu << 14)
+#endif
+
+namespace ttl
+{
+    /// The number of threads to use for `work` units of work.
+    inline auto parallel_threads(std::size_t work) -> std::size_t
+    {
+        std::size_t const n = std::max(1u, std::thread::hardware_concurrency());
+        return std::clamp(work / TTL_PARALLEL_GRAIN, 1zu, n);
+    }
+
+    /// Invoke `f(t)` for each `t` in [0, n), each on its own thread.
+    ///
+    /// The calling thread runs `f(0)`. During constant evaluation, or when
+    /// there is only one task, everything runs serially.
+    inline constexpr void parallel_for(std::size_t n, auto const& f)
+    {
+        if consteval {
+            for (std::size_t t = 0; t != n; ++t) {
+                f(t);
+            }
+        }
+        else {
+            if (n < 2) {
+                for (std::size_t t = 0; t != n; ++t) {
+                    f(t);
+                }
+                return;
+            }
+
+            std::vector<std::jthread> threads;
+            threads.reserve(n - 1);
+            for (std::size_t t = 1; t != n; ++t) {
+                threads.emplace_back([&f, t] { f(t); });
+            }
+            f(0zu);
+        }
+    }
+}
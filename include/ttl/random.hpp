@@ -0,0 +1,151 @@
+#pragma once
+
+#include <ttl/bind.hpp>
+#include <ttl/index.hpp>
+#include <ttl/tspan.hpp>
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mdspan>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace ttl
+{
+    /// The Philox4x32-10 counter-based random bijection.
+    ///
+    /// Each (counter, key) pair maps to four independent 32-bit words, so any
+    /// element of a random stream can be computed without computing the ones
+    /// before it (Salmon et al., "Parallel random numbers: as easy as 1, 2,
+    /// 3", SC'11).
+    inline constexpr auto philox4x32(std::array<std::uint32_t, 4> c, std::array<std::uint32_t, 2> k)
+        -> std::array<std::uint32_t, 4>
+    {
+        constexpr std::uint64_t m0 = 0xD2511F53;
+        constexpr std::uint64_t m1 = 0xCD9E8D57;
+        constexpr std::uint32_t w0 = 0x9E3779B9;
+        constexpr std::uint32_t w1 = 0xBB67AE85;
+
+        for (int round = 0; round < 10; ++round) {
+            std::uint64_t const p0 = m0 * c[0];
+            std::uint64_t const p1 = m1 * c[2];
+            c = {
+                std::uint32_t(p1 >> 32) ^ c[1] ^ k[0],
+                std::uint32_t(p1),
+                std::uint32_t(p0 >> 32) ^ c[3] ^ k[1],
+                std::uint32_t(p0),
+            };
+            k[0] += w0;
+            k[1] += w1;
+        }
+        return c;
+    }
+
+    /// A tensor of random values that is never stored.
+    ///
+    /// The element at row-major offset `n` is word `n % 4` of the Philox block
+    /// for counter `n / 4`, keyed by the seed, so the tensor is stateless,
+    /// reproducible and can be evaluated in any order or in parallel.
+    /// Floating point elements are uniform in [0, 1) with up to 32 bits of
+    /// randomness, and integral elements are the raw bits.
+    ///
+    /// Assignments generate each innermost row in batches of consecutive
+    /// counters (see `generate`).
+    template <class T, std_extents Extents>
+    struct random_tensor {
+        static_assert(std::floating_point<T> or std::integral<T>);
+
+        using value_type = T;
+
+        static constexpr bool is_random = true;
+
+        std::uint64_t _seed;
+        Extents _extents;
+
+        constexpr auto extents() const -> Extents const&
+        {
+            return _extents;
+        }
+
+        constexpr auto seed() const -> std::uint64_t
+        {
+            return _seed;
+        }
+
+        template <std::integral... I>
+            requires(sizeof...(I) == Extents::rank())
+        constexpr auto operator[](I... i) const -> value_type
+        {
+            std::size_t const ind[] { std::size_t(i)..., 0 };
+            std::size_t offset = 0;
+            for (std::size_t r = 0; r < Extents::rank(); ++r) {
+                offset = offset * _extents.extent(r) + ind[r];
+            }
+            return _convert(_block(offset / 4)[offset % 4]);
+        }
+
+        /// Generate the elements at row-major offsets [offset, offset +
+        /// out.size()).
+        ///
+        /// Each Philox block is computed once for its four elements, and the
+        /// blocks are independent of each other.
+        constexpr void generate(std::size_t offset, std::span<value_type> out) const
+        {
+            for (std::size_t k = 0; k < out.size();) {
+                auto const n = offset + k;
+                auto const block = _block(n / 4);
+                for (std::size_t w = n % 4; w < 4 and k < out.size(); ++w, ++k) {
+                    out[k] = _convert(block[w]);
+                }
+            }
+        }
+
+        /// Tensor indexing.
+        constexpr auto operator()(this auto const& self, is_index auto... i)
+            -> decltype(ttl::bind(random_tensor(self), ttl::index(i)...))
+        {
+            static_assert(sizeof...(i) == Extents::rank());
+            return ttl::bind(random_tensor(self), ttl::index(i)...);
+        }
+
+    private:
+        constexpr auto _block(std::uint64_t n) const -> std::array<std::uint32_t, 4>
+        {
+            return philox4x32(
+                { std::uint32_t(n), std::uint32_t(n >> 32), 0, 0 },
+                { std::uint32_t(_seed), std::uint32_t(_seed >> 32) });
+        }
+
+        static constexpr auto _convert(std::uint32_t x) -> value_type
+        {
+            if constexpr (std::floating_point<T>) {
+                // Keep only as many bits as the mantissa holds, so that the
+                // result can't round up to 1.
+                constexpr int bits = std::min(32, std::numeric_limits<T>::digits);
+                return T(x >> (32 - bits)) / T(1ull << bits);
+            }
+            else {
+                return T(x);
+            }
+        }
+    };
+
+    /// Create a random tensor, e.g., random(seed, std::extents<std::size_t, 3>()).
+    template <class T = double, std_extents Extents>
+    inline constexpr auto random(std::uint64_t seed, Extents extents) -> random_tensor<T, Extents>
+    {
+        return random_tensor<T, Extents>(seed, std::move(extents));
+    }
+
+    /// Create a random tensor with dynamic extents, e.g., random(seed, m, n).
+    template <class T = double>
+    inline constexpr auto random(std::uint64_t seed, std::integral auto... n)
+    {
+        return ttl::random<T>(seed, std::dextents<std::size_t, sizeof...(n)>(n...));
+    }
+}
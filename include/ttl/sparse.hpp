@@ -0,0 +1,131 @@
+#pragma once
+
+#include <ttl/bind.hpp>
+#include <ttl/index.hpp>
+#include <ttl/tensor_traits.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <mdspan>
+#include <span>
+#include <type_traits>
+
+namespace ttl
+{
+    /// The compressed storage formats for sparse matrices.
+    enum class sparse_layout {
+        csr, ///< compressed rows
+        csc, ///< compressed columns
+    };
+
+    /// A non-owning view of a compressed sparse matrix.
+    ///
+    /// The `offsets` array has one entry per major slice (rows for CSR, columns
+    /// for CSC) plus one, and the nonzeros of slice `m` are stored in
+    /// [offsets[m], offsets[m+1]). Within each slice the minor `indices` must
+    /// be sorted.
+    ///
+    /// Binding a sparse_span and contracting it with a dense expression only
+    /// visits the stored nonzeros (see `tree::product::_sparse_gather`).
+    template <class T, sparse_layout _layout = sparse_layout::csr, std::integral I = std::size_t>
+    struct sparse_span {
+        using element_type = T;
+        using value_type = std::remove_cv_t<T>;
+        using index_type = I;
+
+        static constexpr sparse_layout layout = _layout;
+
+        /// The slot in (row, column) that is compressed into `offsets`.
+        static constexpr std::size_t major_slot = (_layout == sparse_layout::csr) ? 0 : 1;
+
+        std::span<T> _values;
+        std::span<I const> _indices;
+        std::span<I const> _offsets;
+        std::dextents<std::size_t, 2> _extents;
+
+        constexpr sparse_span(std::span<T> values, std::span<I const> indices, std::span<I const> offsets, std::size_t m, std::size_t n)
+            : _values(values)
+            , _indices(indices)
+            , _offsets(offsets)
+            , _extents(m, n)
+        {
+            assert(_offsets.size() == _extents.extent(major_slot) + 1);
+            assert(_values.size() == _indices.size());
+            assert(_offsets.back() <= _indices.size());
+        }
+
+        constexpr auto extents() const -> std::dextents<std::size_t, 2>
+        {
+            return _extents;
+        }
+
+        constexpr auto values() const -> std::span<T>
+        {
+            return _values;
+        }
+
+        constexpr auto indices() const -> std::span<I const>
+        {
+            return _indices;
+        }
+
+        constexpr auto offsets() const -> std::span<I const>
+        {
+            return _offsets;
+        }
+
+        constexpr auto nonzeros() const -> std::size_t
+        {
+            return _offsets.back() - _offsets.front();
+        }
+
+        /// Find the value at (i,j), returning a value-initialized scalar if
+        /// it isn't stored.
+        constexpr auto operator[](std::size_t i, std::size_t j) const -> value_type
+        {
+            std::size_t const m = (major_slot == 0) ? i : j;
+            std::size_t const n = (major_slot == 0) ? j : i;
+            assert(m < _offsets.size() - 1);
+            auto const begin = _indices.begin() + _offsets[m];
+            auto const end = _indices.begin() + _offsets[m + 1];
+            auto const it = std::lower_bound(begin, end, n);
+            if (it == end or std::size_t(*it) != n) {
+                return value_type {};
+            }
+            return _values[it - _indices.begin()];
+        }
+
+        /// Tensor indexing.
+        constexpr auto operator()(this auto const& self, is_index auto... i)
+            -> decltype(ttl::bind(sparse_span(self), ttl::index(i)...))
+        {
+            static_assert(sizeof...(i) == 2);
+            return ttl::bind(sparse_span(self), ttl::index(i)...);
+        }
+    };
+
+    template <class T, std::integral I = std::size_t>
+    using csr_span = sparse_span<T, sparse_layout::csr, I>;
+
+    template <class T, std::integral I = std::size_t>
+    using csc_span = sparse_span<T, sparse_layout::csc, I>;
+
+    /// Sparse matrices are evaluated by searching their compressed slices.
+    template <class T, sparse_layout layout, class I>
+    struct tensor_traits<sparse_span<T, layout, I>> {
+        using span = sparse_span<T, layout, I>;
+
+        static constexpr auto extents(span const& s)
+        {
+            return s.extents();
+        }
+
+        static constexpr auto evaluate(span const& s, std::size_t i, std::size_t j)
+            -> typename span::value_type
+        {
+            return s[i, j];
+        }
+    };
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <ttl/bind.hpp>
+#include <ttl/evaluate.hpp>
+#include <ttl/extents.hpp>
+#include <ttl/index.hpp>
+#include <ttl/tensor.hpp>
+
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <mdspan>
+#include <type_traits>
+#include <utility>
+
+namespace ttl
+{
+    /// A view of X whose element i... is X(i + offset...).
+    ///
+    /// Shifted views keep the extents of X, so that x(i+1) - x(i-1) has
+    /// compatible operands, and only the elements whose shifted index is
+    /// inside X can be evaluated. Assignments of expressions that contain
+    /// shifted views only visit that interior (see
+    /// `execution_traits::_assign_stencil`), e.g., y(i) = x(i+1) - 2 * x(i) +
+    /// x(i-1) leaves y(0) and y(n-1) alone.
+    ///
+    /// Only the slots in the `_slots` bitmask may have nonzero offsets. The
+    /// indices bound to them must stay free, since a contraction can't be
+    /// clipped to the interior, e.g., x(i+1) * y(i) doesn't compile.
+    template <tensor X, std::uint64_t _slots = ~std::uint64_t(0)>
+    struct shifted {
+        static constexpr std::size_t R = rank<X>;
+        static constexpr bool is_shifted = true;
+        static constexpr std::uint64_t shifted_slots = _slots;
+
+        X _x;
+        std::array<std::ptrdiff_t, R> _offsets;
+
+        constexpr auto offsets() const -> std::array<std::ptrdiff_t, R> const&
+        {
+            return _offsets;
+        }
+
+        constexpr auto extents() const
+        {
+            return ttl::extents(_x);
+        }
+
+        constexpr auto operator[](this auto&& self, std::integral auto... i) -> decltype(auto)
+        {
+            static_assert(sizeof...(i) == R);
+            return [&]<std::size_t... n>(std::index_sequence<n...>) -> decltype(auto) {
+                std::size_t const ind[] { std::size_t(std::ptrdiff_t(i) + self._offsets[n])... };
+                assert(((ind[n] < ttl::extent(self._x, n)) && ...));
+                return ttl::evaluate(__fwd(self)._x, ind[n]...);
+            }(std::make_index_sequence<R>());
+        }
+    };
+
+    /// Create a shifted view, e.g., shift(x, 1)(i) is x(i+1).
+    template <tensor X>
+    inline constexpr auto shift(X&& x, std::integral auto... offsets) -> shifted<X>
+    {
+        static_assert(sizeof...(offsets) == rank<X>);
+        return shifted<X>(__fwd(x), { std::ptrdiff_t(offsets)... });
+    }
+
+    namespace _
+    {
+        inline constexpr auto offset_of(auto const& i) -> std::ptrdiff_t
+        {
+            if constexpr (ttl::is_offset_index<decltype(i)>) {
+                return i.offset();
+            }
+            else {
+                return 0;
+            }
+        }
+
+        template <index_string str>
+        inline constexpr auto unshifted(offset_index<str> const&) -> index<str>
+        {
+            return {};
+        }
+
+        inline constexpr auto unshifted(auto const& i) -> decltype(auto)
+        {
+            return i;
+        }
+    }
+
+    /// Bind a tensor with offset indices by binding a shifted view of it,
+    /// e.g., bind(x, i+1).
+    template <tensor A, is_index... Index>
+        requires(is_offset_index<Index> or ...)
+    inline constexpr auto bind(A&& a, Index const&... ids)
+    {
+        static_assert(sizeof...(ids) == rank<A>);
+        static constexpr auto slots = [] {
+            bool const offset[] { is_offset_index<Index>... };
+            std::uint64_t out = 0;
+            for (std::size_t n = 0; n < sizeof...(Index); ++n) {
+                out |= std::uint64_t(offset[n]) << n;
+            }
+            return out;
+        }();
+        auto view = shifted<A, slots>(__fwd(a), { _::offset_of(ids)... });
+        return ttl::bind(std::move(view), _::unshifted(ids)...);
+    }
+
+    /// A view of the sliding windows of X, whose element (i..., k...) is
+    /// X(i + k...).
+    ///
+    /// The window extents are w..., and the leading extents shrink to the
+    /// number of complete windows, so contracting the window with a kernel is
+    /// a valid convolution, e.g., y(i) = window(x, 3)(i,k) * w(k) or
+    /// Y(i,j) = window(X, 3, 3)(i,j,k,l) * W(k,l).
+    template <tensor X>
+    struct sliding_window {
+        static constexpr std::size_t R = rank<X>;
+
+        using extents_type = std::dextents<std::size_t, 2 * R>;
+
+        X _x;
+        std::array<std::size_t, R> _window;
+
+        constexpr auto extents() const -> extents_type
+        {
+            return [&]<std::size_t... n>(std::index_sequence<n...>) {
+                assert(((_window[n] != 0 and _window[n] <= ttl::extent(_x, n)) && ...));
+                return extents_type(ttl::extent(_x, n) - _window[n] + 1 ..., _window[n]...);
+            }(std::make_index_sequence<R>());
+        }
+
+        constexpr auto operator[](this auto&& self, std::integral auto... i) -> decltype(auto)
+        {
+            static_assert(sizeof...(i) == 2 * R);
+            return [&]<std::size_t... n>(std::index_sequence<n...>) -> decltype(auto) {
+                std::size_t const ind[] { std::size_t(i)... };
+                return ttl::evaluate(__fwd(self)._x, (ind[n] + ind[R + n])...);
+            }(std::make_index_sequence<R>());
+        }
+
+        /// Tensor indexing.
+        constexpr auto operator()(this auto const& self, is_index auto... i)
+            -> decltype(ttl::bind(sliding_window(self), ttl::index(i)...))
+        {
+            static_assert(sizeof...(i) == 2 * R);
+            return ttl::bind(sliding_window(self), ttl::index(i)...);
+        }
+    };
+
+    /// Create a sliding window view with extents w..., e.g., window(x, 3).
+    template <tensor X>
+    inline constexpr auto window(X&& x, std::integral auto... w) -> sliding_window<X>
+    {
+        static_assert(sizeof...(w) == rank<X>);
+        return sliding_window<X>(__fwd(x), { std::size_t(w)... });
+    }
+}
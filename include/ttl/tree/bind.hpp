@@ -17,12 +17,22 @@ namespace ttl::tree
     template <tensor A, index_string _index>
     struct bind : node {
         static_assert(ttl::rank<A> == _index.size());
+        static_assert(_::shifted_indices_free<_index, bind>, "Offset indices can't be contracted.");
 
         static constexpr auto _outer = _index.outer();
         static constexpr auto _inner = _index.inner();
         static constexpr auto _all = _index.all();
         static constexpr auto _rank = _outer.rank();
 
+        /// Check to see if the bound tensor is an mdspan with a strided
+        /// layout. Contractions over strided tensors can be walked directly
+        /// using the sum of the strides of the contracted slots.
+        static constexpr bool _strided = requires(std::remove_cvref_t<A> const& a) {
+            requires std::remove_cvref_t<A>::mapping_type::is_always_strided();
+            a.mapping().stride(0);
+            a.accessor().access(a.data_handle(), 0zu);
+        };
+
         A _a;
         ttl::index<_index> _id;
 
@@ -109,12 +119,85 @@ namespace ttl::tree
         constexpr auto _evaluate(this auto&& self, std::integral auto... i) -> ttl::scalar_type<A>
             requires (_rank <= sizeof...(i) and sizeof...(i) < _inner.size())
         {
-            auto const extents = select_extents(index_map<_index, _inner>, ttl::extents(self._a));
-            accumulator_type<A> accum {};
-            for (std::size_t j = 0, e = extents.extent(sizeof...(i)); j < e; ++j) {
-                accum += self._evaluate(i..., j);
+            if constexpr (_strided and sizeof...(i) == _rank) {
+                return self._evaluate_diagonal(i...);
+            }
+            else {
+                auto const extents = select_extents(index_map<_index, _inner>, ttl::extents(self._a));
+                accumulator_type<A> accum {};
+                for (std::size_t j = 0, e = extents.extent(sizeof...(i)); j < e; ++j) {
+                    accum += self._evaluate(i..., j);
+                }
+                return accum;
+            }
+        }
+
+        /// Evaluate a contraction over a strided tensor, e.g., A(i,i) or
+        /// T(i,i,k).
+        ///
+        /// Once the outer and projected indices are fixed, each contracted
+        /// index walks a diagonal whose stride is the sum of the strides of its
+        /// two slots. We compute the starting offset and the diagonal strides
+        /// once, and then walk the data handle directly rather than building a
+        /// full multi-index for every element.
+        constexpr auto _evaluate_diagonal(this auto const& self, std::integral auto... i) -> ttl::scalar_type<A>
+        {
+            static constexpr auto contracted = _index.contracted();
+            static constexpr std::size_t N = contracted.size();
+
+            auto const& mapping = self._a.mapping();
+            auto const& accessor = self._a.accessor();
+            auto const handle = self._a.data_handle();
+
+            // Compute the offset of the diagonal's first element.
+            std::size_t const outer[] { std::size_t(i)..., 0zu };
+            std::size_t offset = 0;
+            for (std::size_t s = 0; s < _index.size(); ++s) {
+                if (_index[s] == projected_index) {
+                    offset += self._id[s] * mapping.stride(s);
+                }
+                else if (_outer.count(_index[s]) != 0) {
+                    offset += outer[_outer.index_of(_index[s])] * mapping.stride(s);
+                }
+            }
+
+            // Compute the extents and combined strides of the diagonals.
+            std::size_t extents[N];
+            std::size_t strides[N];
+            for (std::size_t n = 0; n < N; ++n) {
+                auto const [j, k] = _index.find_offsets(contracted[n]);
+                extents[n] = ttl::extent(self._a, j);
+                strides[n] = mapping.stride(j) + mapping.stride(k);
             }
-            return accum;
+
+            // Walk the diagonals. The innermost one uses a few independent
+            // partial sums so that the accumulation can be vectorized.
+            auto const walk = [&](this auto const& walk, std::size_t n, std::size_t o) -> accumulator_type<A> {
+                auto const e = extents[n];
+                auto const d = strides[n];
+                if (n + 1 < N) {
+                    accumulator_type<A> accum {};
+                    for (std::size_t j = 0; j < e; ++j, o += d) {
+                        accum += walk(n + 1, o);
+                    }
+                    return accum;
+                }
+
+                accumulator_type<A> accum[4] {};
+                std::size_t j = 0;
+                for (; j + 4 <= e; j += 4, o += 4 * d) {
+                    accum[0] += accessor.access(handle, o);
+                    accum[1] += accessor.access(handle, o + d);
+                    accum[2] += accessor.access(handle, o + 2 * d);
+                    accum[3] += accessor.access(handle, o + 3 * d);
+                }
+                for (; j < e; ++j, o += d) {
+                    accum[0] += accessor.access(handle, o);
+                }
+                return (accum[0] + accum[1]) + (accum[2] + accum[3]);
+            };
+
+            return walk(0, offset);
         }
     };
 }
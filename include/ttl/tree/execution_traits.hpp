@@ -3,25 +3,1088 @@
 #include <ttl/bind.hpp>
 #include <ttl/extents.hpp>
 #include <ttl/evaluate.hpp>
+#include <ttl/layout.hpp>
 #include <ttl/outer.hpp>
+#include <ttl/parallel.hpp>
 #include <ttl/tensor.hpp>
 #include <ttl/tree/bind.hpp>
+#include <ttl/tree/product.hpp>
+#include <ttl/tree/rewrite.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+/// Outer products whose output is larger than this many bytes are written with
+/// non-temporal stores, since the output won't be reused from cache anyway. This
+/// should be set to roughly the size of the last level cache.
+#ifndef TTL_STREAMING_STORE_BYTES
+#define TTL_STREAMING_STORE_BYTES (32zu << 20)
+#endif
+
+/// Stencil assignments sweep the innermost index in strips of this many
+/// elements, so that the neighbouring rows of a strip stay in cache while the
+/// rows are swept.
+#ifndef TTL_STENCIL_STRIP
+#define TTL_STENCIL_STRIP 512zu
+#endif
+
+/// Assignments simplify their expressions algebraically before evaluating them
+/// (see `tree::_::simplify`). The rewrites reassociate scalars, so defining this
+/// as 0 keeps floating point results bitwise identical to the expression as it
+/// was written.
+#ifndef TTL_REWRITE
+#define TTL_REWRITE 1
+#endif
 
 namespace ttl::tree
 {
+    namespace _
+    {
+        /// Invoke `f(i...)` for every index in `extents`, in row-major order.
+        template <std::size_t N = 0>
+        inline constexpr void for_each_index(auto const& extents, auto const& f, std::integral auto... i)
+        {
+            if constexpr (N == std::remove_cvref_t<decltype(extents)>::rank()) {
+                f(i...);
+            }
+            else {
+                for (auto j = 0zu, e = extents.extent(N); j != e; ++j) {
+                    for_each_index<N + 1>(extents, f, i..., j);
+                }
+            }
+        }
+
+        /// Invoke `f(i...)` for every index in the box [lo, hi), in row-major
+        /// order.
+        template <std::size_t N = 0>
+        inline constexpr void for_each_box(auto const& lo, auto const& hi, auto const& f, std::integral auto... i)
+        {
+            if constexpr (N == std::tuple_size_v<std::remove_cvref_t<decltype(lo)>>) {
+                f(i...);
+            }
+            else {
+                for (auto j = std::size_t(lo[N]), e = std::size_t(hi[N]); j != e; ++j) {
+                    for_each_box<N + 1>(lo, hi, f, i..., j);
+                }
+            }
+        }
+    }
+
+    /// A bind of a random tensor to distinct indices (see
+    /// `ttl::random_tensor`).
+    template <class T>
+    concept random_bind = is_bind<T>
+        and requires { requires _::is_bind<std::remove_cvref_t<T>>::tensor_type::is_random; }
+        and _::is_bind<std::remove_cvref_t<T>>::index.outer().size() == _::is_bind<std::remove_cvref_t<T>>::index.size();
+
+    /// A packed triangular matrix as the target of an assignment, either bound
+    /// to two distinct indices or unbound, e.g., L = A(i,j) (see
+    /// `ttl::layout_packed_triangular`).
+    template <class T>
+    concept triangular_output = triangular_bind<T> or (not expression<T> and packed_triangular<T>);
+
     template <tensor A, tensor B>
     struct execution_traits
     {
         static_assert(rank<A> == rank<B>);
 
         static constexpr auto assign(A&& a, B&& b) -> decltype(a)
+            requires(not sparse_bind<A>)
         {
             assert(compatible_extents(extents(a), extents(b)));
+            if constexpr (TTL_REWRITE) {
+                if constexpr (_::simplifiable<B>) {
+                    auto const s = _::simplify(b);
+                    execution_traits<A&, decltype(s) const&>::assign(a, s);
+                    return a;
+                }
+            }
+            if constexpr (_::alternative_node<B>) {
+                if (b._rewritten) {
+                    // An unbound `a` is assigned in the order of the outer
+                    // indices of the right hand side, so a rewrite that
+                    // reorders them is evaluated through the alternative.
+                    if constexpr (expression<A> or outer<decltype(b._a)> == outer<B>) {
+                        execution_traits<A&, decltype(b._a) const&>::assign(a, b._a);
+                    }
+                    else {
+                        _assign_unrewritten(__fwd(a), __fwd(b));
+                    }
+                }
+                else {
+                    execution_traits<A&, decltype(b._b) const&>::_assign_unrewritten(a, b._b);
+                }
+                return a;
+            }
+            return _assign_unrewritten(__fwd(a), __fwd(b));
+        }
+
+        /// Assign an expression as it is, without simplifying it, e.g., the
+        /// original expression of an `alternative` whose rewrite didn't hold.
+        static constexpr auto _assign_unrewritten(A&& a, B&& b) -> decltype(a)
+            requires(not sparse_bind<A>)
+        {
+            // Packed outputs come first, since every other kernel writes every
+            // element of `a`, and these alias.
+            if constexpr (symmetric_bind<A>) {
+                _assign_packed_symmetric(a, b);
+                return a;
+            }
+            if constexpr (triangular_output<A>) {
+                _assign_packed_triangular(a, b);
+                return a;
+            }
+            if constexpr (voigt_bind<A>) {
+                _assign_voigt(a, b);
+                return a;
+            }
+            if constexpr (_::common_paths<B>.size() != 0) {
+                if (_::common_leaves(b)) {
+                    _assign_materialized<_::common_paths<B>>(a, b);
+                    return a;
+                }
+            }
+            if constexpr (_::scan_paths<B>.size() > (_scan<B> and _same_order<B>)) {
+                _assign_materialized<std::array { _::scan_paths<B>.back() }>(a, b);
+                return a;
+            }
+            if constexpr (expression<A> and (_stencil<A> or _stencil<B>)) {
+                _assign_stencil(a, b);
+                return a;
+            }
+            if constexpr (symmetric_product<B>) {
+                if (b._is_symmetric()) {
+                    _assign_symmetric(a, b);
+                    return a;
+                }
+            }
+            if constexpr (sparse_product<B> and _same_order<B>) {
+                if constexpr (std::remove_cvref_t<B>::_sparse_gather) {
+                    _assign_sparse_gather(a, b);
+                }
+                else {
+                    _assign_sparse_scatter(a, b);
+                }
+                return a;
+            }
+            if constexpr (random_bind<B> and _same_order<B> and rank<A> != 0) {
+                _assign_random(a, b);
+                return a;
+            }
+            if constexpr (semiring_matrix_product<B> and _same_order<B>) {
+                _assign_semiring(a, b);
+                return a;
+            }
+            if constexpr (_scan<B> and _same_order<B>) {
+                _assign_scan(a, b);
+                return a;
+            }
+            if constexpr (outer_product<B> and _same_order<B>) {
+                _assign_outer(a, b, [](auto const& v, auto...) {
+                    return v;
+                });
+                return a;
+            }
+            if constexpr (_rank_one_update<B> and _same_order<B>) {
+                _assign_outer(a, b._b, [&](auto const& v, auto... i) {
+                    return std::remove_cvref_t<B>::_op(evaluate(b._a, i...), v);
+                });
+                return a;
+            }
+            if constexpr (rank<A> == 2 and (_tile<A>[0] != 0 or _tile<B>[0] != 0)) {
+                _assign_tiled(a, b, _tile<A>[0] ? _tile<A> : _tile<B>);
+                return a;
+            }
             _assign(a, __fwd(b));
             return a;
         }
 
+        /// Assign to a bound sparse matrix, e.g., S(i,j) = A(i,k) * B(k,j).
+        ///
+        /// Only the stored entries of the output are evaluated, i.e., this is
+        /// a sampled dense-dense product, which costs O(nnz * k) rather than
+        /// the O(n^2 * k) of a dense assignment.
+        static constexpr auto assign(A&& a, B&& b) -> decltype(a)
+            requires sparse_bind<A>
+        {
+            assert(compatible_extents(extents(a), _extents_as(b)));
+            auto const values = a._a.values();
+            _for_each_nonzero(a, [&](std::size_t k, std::size_t i, std::size_t j) {
+                values[k] = _evaluate_as(b, i, j);
+            });
+            return a;
+        }
+
+        /// Assign `b` only where `m` is nonzero, leaving the rest of `a`
+        /// untouched.
+        ///
+        /// If `m` is a bound sparse matrix then its stored entries are the
+        /// pattern, and only those elements of `b` are evaluated.
+        template <tensor M>
+        static constexpr auto assign_masked(A&& a, M const& m, B&& b) -> decltype(a)
+        {
+            static_assert(rank<A> == rank<M> and rank<A> != 0);
+            assert(compatible_extents(extents(a), _extents_as(b)));
+            assert(compatible_extents(extents(a), _extents_as(m)));
+            if constexpr (sparse_bind<M>) {
+                _for_each_nonzero(m, [&](std::size_t, std::size_t i, std::size_t j) {
+                    if (_stores(i, j)) {
+                        evaluate(a, i, j) = _evaluate_as(b, i, j);
+                    }
+                });
+            }
+            else {
+                auto const e = ttl::extents(a);
+                std::size_t nt = 1;
+                if !consteval {
+                    std::size_t n = 1;
+                    for (std::size_t r = 0; r < e.rank(); ++r) {
+                        n *= e.extent(r);
+                    }
+                    nt = std::min(parallel_threads(n), e.extent(0));
+                }
+                parallel_for(nt, [&](std::size_t t) {
+                    for (std::size_t r = e.extent(0) * t / nt, end = e.extent(0) * (t + 1) / nt; r != end; ++r) {
+                        _for_each_slice<0>(e, r, [&](auto... i) {
+                            if (_stores(i...) and _evaluate_as(m, i...)) {
+                                evaluate(a, i...) = _evaluate_as(b, i...);
+                            }
+                        });
+                    }
+                });
+            }
+            return a;
+        }
+
     private:
+        /// Check to see if the element i... of `a` is stored, i.e., it isn't in
+        /// the implicit zero half of a packed triangular matrix.
+        static constexpr bool _stores(std::integral auto... i)
+        {
+            if constexpr (triangular_output<A>) {
+                using L = layout_packed_triangular<_triangle()>;
+                return L::template mapping<std::dextents<std::size_t, 2>>::stores(i...);
+            }
+            else {
+                return true;
+            }
+        }
+
+        /// The stored triangle of a packed triangular output.
+        static constexpr auto _triangle() -> triangle
+        {
+            if constexpr (expression<A>) {
+                return _::is_bind<std::remove_cvref_t<A>>::tensor_type::layout_type::stored;
+            }
+            else {
+                return std::remove_cvref_t<A>::layout_type::stored;
+            }
+        }
+
+        /// The extents of `t` in the outer order of `A`.
+        template <class T>
+        static constexpr auto _extents_as(T const& t)
+        {
+            if constexpr (expression<A> and expression<T>) {
+                return select_extents(index_map<outer<T>, outer<A>>, ttl::extents(t));
+            }
+            else {
+                return ttl::extents(t);
+            }
+        }
+
+        /// Evaluate `t` at the index i... given in the outer order of `A`.
+        template <class T>
+        static constexpr auto _evaluate_as(T const& t, std::integral auto... i) -> decltype(auto)
+        {
+            if constexpr (expression<A> and expression<T>) {
+                static constexpr auto map = index_map<outer<A>, outer<T>>;
+                return [&]<std::size_t... m>(std::index_sequence<m...>) -> decltype(auto) {
+                    std::size_t const ind[] { std::size_t(i)... };
+                    return evaluate(t, ind[m]...);
+                }(map);
+            }
+            else {
+                return evaluate(t, i...);
+            }
+        }
+
+        /// Invoke `f(k, i, j)` for each nonzero `k` of the bound sparse matrix
+        /// `s`, where (i,j) is its position in the outer order of `A`.
+        ///
+        /// The compressed slices are visited in parallel (see
+        /// `_parallel_slices`).
+        static constexpr void _for_each_nonzero(auto const& s, auto const& f)
+        {
+            using S = _::is_bind<std::remove_cvref_t<decltype(s)>>;
+            static constexpr auto major = S::tensor_type::major_slot;
+            static constexpr bool transposed = outer<A>[0] != S::index[0];
+
+            auto const offsets = s._a.offsets();
+            auto const indices = s._a.indices();
+            _parallel_slices(offsets, [&](std::size_t m) {
+                for (std::size_t k = offsets[m], e = offsets[m + 1]; k != e; ++k) {
+                    std::size_t const x[2] { m, std::size_t(indices[k]) };
+                    std::size_t const i = x[major == 0 ? 0 : 1];
+                    std::size_t const j = x[major == 0 ? 1 : 0];
+                    if constexpr (transposed) {
+                        f(k, j, i);
+                    }
+                    else {
+                        f(k, i, j);
+                    }
+                }
+            });
+        }
+
+        /// Check to see if `T` is a sum of the form X(i,j) + x(i) * y(j) (see
+        /// `sum::_rank_one_pattern`).
+        ///
+        /// @note We can't include sum.hpp here to write this as a concept,
+        ///       because its operator+ would change the meaning of the index
+        ///       concatenation in node::operator() before bind.hpp defines it.
+        template <class T>
+        static constexpr bool _rank_one_update = requires {
+            requires std::remove_cvref_t<T>::_rank_one_pattern;
+        };
+
+        /// Check to see if `T` is a prefix scan (see `tree::scan`).
+        template <class T>
+        static constexpr bool _scan = requires {
+            std::remove_cvref_t<T>::_scan_slot;
+        };
+
+        /// Check to see if the expression `T` binds any shifted views (see
+        /// `ttl::shifted`).
+        template <class T>
+        static constexpr bool _stencil = [] {
+            using U = std::remove_cvref_t<T>;
+            if constexpr (is_bind<U> and requires { requires _::is_bind<U>::tensor_type::is_shifted; }) {
+                return true;
+            }
+            else if constexpr (requires { std::declval<U const&>()._b; }) {
+                return _stencil<decltype(std::declval<U const&>()._a)> or _stencil<decltype(std::declval<U const&>()._b)>;
+            }
+            else if constexpr (requires { std::declval<U const&>()._a; }) {
+                return _stencil<decltype(std::declval<U const&>()._a)>;
+            }
+            else {
+                return false;
+            }
+        }();
+
+        /// Shrink the box [lo, hi) of output indices to the ones for which
+        /// every shifted view in `t` stays inside its tensor.
+        ///
+        /// The indices bound to shifted slots are always free (see
+        /// `_::shifted_indices_free`). `names` spells the outer indices of `A`
+        /// as they are named inside `t`, which changes under rebinds, so it
+        /// starts as `outer<A>`.
+        template <index_string names, class T>
+        static constexpr void _stencil_box(T const& t, auto& lo, auto& hi)
+        {
+            using U = std::remove_cvref_t<T>;
+            if constexpr (is_bind<U> and requires { requires _::is_bind<U>::tensor_type::is_shifted; }) {
+                using X = typename _::is_bind<U>::tensor_type;
+                static constexpr auto index = _::is_bind<U>::index;
+                auto const& offsets = t._a.offsets();
+                for (std::size_t s = 0; s < index.size(); ++s) {
+                    if (not (X::shifted_slots >> s & 1)) {
+                        continue;
+                    }
+                    auto const p = names.index_of(index[s]);
+                    assert(p < names.size());
+                    auto const n = std::ptrdiff_t(ttl::extent(t._a, s));
+                    lo[p] = std::max(lo[p], -offsets[s]);
+                    hi[p] = std::min(hi[p], n - offsets[s]);
+                }
+            }
+            else if constexpr (is_bind<U>) {
+                // Rename the outer indices of `A` to the names that a rebound
+                // expression uses.
+                using X = typename _::is_bind<U>::tensor_type;
+                if constexpr (expression<X>) {
+                    static constexpr auto index = _::is_bind<U>::index;
+                    static constexpr auto renamed = [] {
+                        auto out = names;
+                        for (std::size_t p = 0; p < names.size(); ++p) {
+                            auto const q = index.index_of(names[p]);
+                            out._data[p] = (index.count(names[p]) == 1) ? outer<X>[q] : projected_index;
+                        }
+                        return out;
+                    }();
+                    _stencil_box<renamed>(t._a, lo, hi);
+                }
+            }
+            else if constexpr (requires { t._b; }) {
+                _stencil_box<names>(t._a, lo, hi);
+                _stencil_box<names>(t._b, lo, hi);
+            }
+            else if constexpr (requires { t._a; }) {
+                _stencil_box<names>(t._a, lo, hi);
+            }
+        }
+
+        /// The loop blocking of the first tiled tensor in the expression `T`,
+        /// or {0, 0} if there isn't one (see `ttl::tiled`).
+        template <class T>
+        static constexpr std::array<std::size_t, 2> _tile = [] -> std::array<std::size_t, 2> {
+            using U = std::remove_cvref_t<T>;
+            if constexpr (is_bind<U>) {
+                if constexpr (tiled<typename _::is_bind<U>::tensor_type>) {
+                    return _::is_bind<U>::tensor_type::layout_type::tile;
+                }
+                else {
+                    return { 0, 0 };
+                }
+            }
+            else if constexpr (tiled<U>) {
+                return U::layout_type::tile;
+            }
+            else if constexpr (requires { std::declval<U const&>()._b; }) {
+                auto const tile = _tile<decltype(std::declval<U const&>()._a)>;
+                return tile[0] ? tile : _tile<decltype(std::declval<U const&>()._b)>;
+            }
+            else if constexpr (requires { std::declval<U const&>()._a; }) {
+                return _tile<decltype(std::declval<U const&>()._a)>;
+            }
+            else {
+                return { 0, 0 };
+            }
+        }();
+
+        /// Check to see if the output and the expression `T` order their outer
+        /// indices in the same way, so that no remapping is required.
+        template <class T>
+        static constexpr bool _same_order = [] {
+            if constexpr (expression<A> and expression<T>) {
+                return outer<A> == outer<T>;
+            }
+            else {
+                return true;
+            }
+        }();
+
+        /// Invoke `f(i...)` for every index in `extents` whose `P`th slot is
+        /// `m`, in row-major order.
+        template <std::size_t P, std::size_t N = 0>
+        static constexpr void _for_each_slice(auto const& extents, std::size_t m, auto const& f, std::integral auto... i)
+        {
+            if constexpr (N == std::remove_cvref_t<decltype(extents)>::rank()) {
+                f(i...);
+            }
+            else if constexpr (N == P) {
+                _for_each_slice<P, N + 1>(extents, m, f, i..., m);
+            }
+            else {
+                for (auto j = 0zu, e = extents.extent(N); j != e; ++j) {
+                    _for_each_slice<P, N + 1>(extents, m, f, i..., j);
+                }
+            }
+        }
+
+        /// Invoke `f(i...)` for every index in `extents` whose `P`th slot is
+        /// `m` and whose `Q`th slot is `r`, in row-major order.
+        template <std::size_t P, std::size_t Q, std::size_t N = 0>
+        static constexpr void _for_each_slice_pair(auto const& extents, std::size_t m, std::size_t r, auto const& f, std::integral auto... i)
+        {
+            if constexpr (N == std::remove_cvref_t<decltype(extents)>::rank()) {
+                f(i...);
+            }
+            else if constexpr (N == P) {
+                _for_each_slice_pair<P, Q, N + 1>(extents, m, r, f, i..., m);
+            }
+            else if constexpr (N == Q) {
+                _for_each_slice_pair<P, Q, N + 1>(extents, m, r, f, i..., r);
+            }
+            else {
+                for (auto j = 0zu, e = extents.extent(N); j != e; ++j) {
+                    _for_each_slice_pair<P, Q, N + 1>(extents, m, r, f, i..., j);
+                }
+            }
+        }
+
+        /// Invoke `f(m)` for each compressed slice `m` described by `offsets`.
+        ///
+        /// The slices are partitioned across threads in contiguous ranges with
+        /// roughly equal numbers of nonzeros, so `f` must only write to
+        /// outputs owned by its slice.
+        static constexpr void _parallel_slices(auto const& offsets, auto const& f)
+        {
+            auto const n = offsets.size() - 1;
+            auto const nnz = std::size_t(offsets[n] - offsets[0]);
+
+            auto const partition = [&](std::size_t t, std::size_t nt) -> std::size_t {
+                if (t == nt) {
+                    return n;
+                }
+                auto const target = offsets[0] + nnz * t / nt;
+                return std::lower_bound(offsets.begin(), offsets.end(), target) - offsets.begin();
+            };
+
+            std::size_t nt = 1;
+            if !consteval {
+                nt = parallel_threads(nnz);
+            }
+
+            parallel_for(nt, [&](std::size_t t) {
+                for (std::size_t m = partition(t, nt), e = partition(t + 1, nt); m < e; ++m) {
+                    f(m);
+                }
+            });
+        }
+
+        /// Assign a sparse gather, e.g., y(i) = A(i,j) * x(j) for a CSR A.
+        ///
+        /// Every output element in the slice of the sparse major index only
+        /// depends on the nonzeros stored in that slice, so the slices can be
+        /// assigned in parallel.
+        static constexpr void _assign_sparse_gather(A& a, B const& b)
+        {
+            using P = std::remove_cvref_t<B>;
+            _parallel_slices(b._sparse().offsets(), [&](std::size_t m) {
+                _for_each_slice<P::_sparse_slot>(ttl::extents(a), m, [&](auto... i) {
+                    evaluate(a, i...) = evaluate(b, i...);
+                });
+            });
+        }
+
+        /// Assign a sparse scatter, e.g., y(i) = A(i,j) * x(j) for a CSC A.
+        ///
+        /// The output is cleared and then each nonzero is accumulated into the
+        /// output slice of its minor index. Different major slices write to
+        /// the same outputs, so this runs serially.
+        static constexpr void _assign_sparse_scatter(A& a, B const& b)
+        {
+            using P = std::remove_cvref_t<B>;
+            auto const& s = b._sparse();
+            auto const offsets = s.offsets();
+            auto const indices = s.indices();
+            auto const values = s.values();
+
+            _::for_each_index(ttl::extents(a), [&](auto... i) {
+                evaluate(a, i...) = P::_identity();
+            });
+
+            for (std::size_t m = 0, n = offsets.size() - 1; m != n; ++m) {
+                for (std::size_t k = offsets[m], e = offsets[m + 1]; k != e; ++k) {
+                    _for_each_slice<P::_sparse_slot>(ttl::extents(a), indices[k], [&](auto... i) {
+                        auto&& c = evaluate(a, i...);
+                        c = P::_reduce(c, b._sparse_combine(values[k], i..., m));
+                    });
+                }
+            }
+        }
+
+        /// Assign a semiring matrix product, e.g.,
+        /// D(i,j) = min_plus(A(i,k), B(k,j)).
+        ///
+        /// Each output row is accumulated in a buffer seeded with the identity
+        /// of the reduction, in i-k-j order, so the innermost loop streams
+        /// across the right operand and is free of dependencies. The rows are
+        /// independent, so they are assigned in parallel.
+        static constexpr void _assign_semiring(A& a, B const& b)
+        {
+            using P = std::remove_cvref_t<B>;
+            using TA = _::is_bind<std::remove_cvref_t<decltype(b._a)>>;
+            using TB = _::is_bind<std::remove_cvref_t<decltype(b._b)>>;
+            static constexpr char c = (TA::index + TB::index).contracted()[0];
+
+            auto const& ta = b._a._a;
+            auto const& tb = b._b._a;
+
+            auto const fa = [&](std::size_t i, std::size_t k) {
+                if constexpr (TA::index[1] == c) {
+                    return evaluate(ta, i, k);
+                }
+                else {
+                    return evaluate(ta, k, i);
+                }
+            };
+
+            auto const fb = [&](std::size_t k, std::size_t j) {
+                if constexpr (TB::index[0] == c) {
+                    return evaluate(tb, k, j);
+                }
+                else {
+                    return evaluate(tb, j, k);
+                }
+            };
+
+            auto const m = extent<0>(a);
+            auto const n = extent<1>(a);
+            auto const l = ttl::extent(ta, TA::index.index_of(c));
+
+            std::size_t nt = 1;
+            if !consteval {
+                nt = std::min(parallel_threads(m * n * l), m);
+            }
+
+            parallel_for(nt, [&](std::size_t t) {
+                // Not a vector, which would pack boolean rows into bits.
+                auto const row = std::make_unique<typename P::accumulator_type[]>(n);
+                for (std::size_t i = m * t / nt, end = m * (t + 1) / nt; i != end; ++i) {
+                    std::fill_n(row.get(), n, P::_identity());
+                    for (std::size_t k = 0; k != l; ++k) {
+                        auto const u = fa(i, k);
+                        for (std::size_t j = 0; j != n; ++j) {
+                            row[j] = P::_reduce(row[j], P::_op(u, fb(k, j)));
+                        }
+                    }
+                    for (std::size_t j = 0; j != n; ++j) {
+                        evaluate(a, i, j) = row[j];
+                    }
+                }
+            });
+        }
+
+        /// Assign an expression with shifted views, e.g., y(i) = x(i+1) - 2 *
+        /// x(i) + x(i-1).
+        ///
+        /// Only the box of output indices for which every shifted view stays
+        /// inside its tensor is assigned, and the rest of the output is left
+        /// alone. The box is swept in parallel along the outermost index and
+        /// in strips of `TTL_STENCIL_STRIP` along the innermost one, so that
+        /// the neighbours of each element are reused from cache, and the
+        /// innermost loop is contiguous so that compilers can keep the
+        /// overlapping neighbours in registers. The output must not alias any
+        /// of the shifted operands.
+        static constexpr void _assign_stencil(A& a, B const& b)
+        {
+            static constexpr std::size_t R = rank<A>;
+            auto const e = ttl::extents(a);
+
+            std::array<std::ptrdiff_t, R> lo {};
+            std::array<std::ptrdiff_t, R> hi {};
+            for (std::size_t p = 0; p < R; ++p) {
+                hi[p] = std::ptrdiff_t(e.extent(p));
+            }
+            _stencil_box<outer<A>>(a, lo, hi);
+            _stencil_box<outer<A>>(b, lo, hi);
+
+            std::size_t size = 1;
+            for (std::size_t p = 0; p < R; ++p) {
+                if (hi[p] <= lo[p]) {
+                    return;
+                }
+                size *= std::size_t(hi[p] - lo[p]);
+            }
+
+            auto const rows = std::size_t(hi[0] - lo[0]);
+            std::size_t nt = 1;
+            if !consteval {
+                nt = std::min(parallel_threads(size), rows);
+            }
+
+            auto const f = [&](auto... i) {
+                evaluate(a, i...) = _evaluate_as(b, i...);
+            };
+
+            parallel_for(nt, [&](std::size_t t) {
+                auto blo = lo;
+                auto bhi = hi;
+                blo[0] = lo[0] + std::ptrdiff_t(rows * t / nt);
+                bhi[0] = lo[0] + std::ptrdiff_t(rows * (t + 1) / nt);
+                if constexpr (R == 1) {
+                    _::for_each_box(blo, bhi, f);
+                }
+                else {
+                    constexpr auto strip = std::ptrdiff_t(TTL_STENCIL_STRIP);
+                    for (auto j0 = lo[R - 1]; j0 < hi[R - 1]; j0 += strip) {
+                        blo[R - 1] = j0;
+                        bhi[R - 1] = std::min(j0 + strip, hi[R - 1]);
+                        _::for_each_box(blo, bhi, f);
+                    }
+                }
+            });
+        }
+
+        /// Assign an expression with one of its subexpressions evaluated
+        /// ahead of time.
+        ///
+        /// The subtree at qs[0] is assigned to a temporary once, and then the
+        /// expression is assigned with the subtree at each of the paths in qs
+        /// replaced by a bind of the temporary to its outer indices. Both
+        /// assignments recurse, so the remaining cases are handled in turn.
+        ///
+        /// 1. Repeats of a common subexpression (see `_::common_paths`), e.g.,
+        ///    C(i,j) = A(i,k) * B(k,j) + A(i,k) * B(k,j) * s, are evaluated
+        ///    once. Larger repeats come first, so nested ones are found once
+        ///    the enclosing ones have been replaced.
+        /// 2. Scans that aren't assigned by themselves in the output's order,
+        ///    e.g., y(i) = scan(x(i), i) / s or Y(j,i) = scan(X(i,j), j),
+        ///    are assigned in linear time (see `_assign_scan`), rather than
+        ///    reducing a prefix for every element. Scans that contain scans
+        ///    come later.
+        template <auto qs>
+        static constexpr void _assign_materialized(A& a, B const& b)
+        {
+            auto const& s = _::at<qs[0]>(b);
+            using S = std::remove_cvref_t<decltype(s)>;
+            using T = accumulator_type<S>;
+
+            auto const e = ttl::extents(s);
+            std::size_t n = 1;
+            for (std::size_t r = 0; r < e.rank(); ++r) {
+                n *= e.extent(r);
+            }
+            auto const data = std::make_unique<T[]>(n);
+            auto const view = std::mdspan(data.get(), e);
+            using V = std::remove_const_t<decltype(view)>;
+
+            execution_traits<bind<V, outer<S>>, S const&>::assign(bind<V, outer<S>>(view), s);
+            auto const c = _::substitute<qs>(b, [&]<_::path q>(auto const&) {
+                return bind<V, outer<_::subtree<B, q>>>(view);
+            });
+            execution_traits<A&, decltype(c) const&>::assign(a, c);
+        }
+
+        /// Assign a prefix scan, e.g., Y(i,j) = scan(X(i,j), j).
+        ///
+        /// Each element of the operand is read once, before its output is
+        /// written, so scans can be assigned in place. There are three cases.
+        ///
+        /// 1. A single line is scanned with a two-pass blocked scan: each
+        ///    thread reduces its block, the block totals are scanned serially,
+        ///    and then each thread scans its block starting from its total.
+        /// 2. When the scanned index is the innermost one, each line is
+        ///    scanned on its own, and the lines are assigned in parallel.
+        /// 3. Otherwise we step along the scanned index and update a buffer of
+        ///    running values for all of the other indices at once, so the
+        ///    innermost loop is contiguous and free of dependencies. The
+        ///    buffer is partitioned across threads along another index.
+        static constexpr void _assign_scan(A& a, B const& b)
+        {
+            using S = std::remove_cvref_t<B>;
+            using T = typename S::scalar_type;
+            static constexpr std::size_t R = rank<A>;
+            static constexpr std::size_t s = S::_scan_slot;
+
+            auto const& x = b._a;
+            auto const e = ttl::extents(a);
+            auto const n = e.extent(s);
+
+            std::size_t size = 1;
+            for (std::size_t k = 0; k < R; ++k) {
+                size *= e.extent(k);
+            }
+
+            auto const step = [&](T& c, auto... i) {
+                T const v = evaluate(x, i...);
+                if constexpr (S::_exclusive) {
+                    evaluate(a, i...) = c;
+                    c = S::_op(c, v);
+                }
+                else {
+                    c = S::_op(c, v);
+                    evaluate(a, i...) = c;
+                }
+            };
+
+            if constexpr (R == 1) {
+                std::size_t nt = 1;
+                if !consteval {
+                    nt = std::min(parallel_threads(n), n);
+                }
+                if (nt < 2) {
+                    T c = S::_identity();
+                    for (std::size_t k = 0; k != n; ++k) {
+                        step(c, k);
+                    }
+                    return;
+                }
+
+                auto const totals = std::make_unique<T[]>(nt);
+                parallel_for(nt, [&](std::size_t t) {
+                    T c = S::_identity();
+                    for (std::size_t k = n * t / nt, end = n * (t + 1) / nt; k != end; ++k) {
+                        c = S::_op(c, T(evaluate(x, k)));
+                    }
+                    totals[t] = c;
+                });
+
+                T c = S::_identity();
+                for (std::size_t t = 0; t != nt; ++t) {
+                    T const v = totals[t];
+                    totals[t] = c;
+                    c = S::_op(c, v);
+                }
+
+                parallel_for(nt, [&](std::size_t t) {
+                    T c = totals[t];
+                    for (std::size_t k = n * t / nt, end = n * (t + 1) / nt; k != end; ++k) {
+                        step(c, k);
+                    }
+                });
+            }
+            else if constexpr (s == R - 1) {
+                auto const prefix = select_extents(std::make_index_sequence<R - 1>(), e);
+                std::size_t nt = 1;
+                if !consteval {
+                    nt = std::min(parallel_threads(size), e.extent(0));
+                }
+                parallel_for(nt, [&](std::size_t t) {
+                    for (std::size_t m = e.extent(0) * t / nt, end = e.extent(0) * (t + 1) / nt; m != end; ++m) {
+                        _for_each_slice<0>(prefix, m, [&](auto... i) {
+                            T c = S::_identity();
+                            for (std::size_t k = 0; k != n; ++k) {
+                                step(c, i..., k);
+                            }
+                        });
+                    }
+                });
+            }
+            else {
+                static constexpr std::size_t q = (s == 0) ? 1 : 0;
+                auto const l = e.extent(q);
+                auto const w = (n and l) ? size / (n * l) : 0;
+                std::size_t nt = 1;
+                if !consteval {
+                    nt = std::min(parallel_threads(size), l);
+                }
+                parallel_for(nt, [&](std::size_t t) {
+                    auto const r0 = l * t / nt;
+                    auto const r1 = l * (t + 1) / nt;
+                    auto const carry = std::make_unique<T[]>((r1 - r0) * w);
+                    std::fill_n(carry.get(), (r1 - r0) * w, S::_identity());
+                    for (std::size_t k = 0; k != n; ++k) {
+                        std::size_t v = 0;
+                        for (std::size_t r = r0; r != r1; ++r) {
+                            _for_each_slice_pair<s, q>(e, k, r, [&](auto... i) {
+                                step(carry[v++], i...);
+                            });
+                        }
+                    }
+                });
+            }
+        }
+
+        /// Assign a rank-2 expression one tile at a time.
+        ///
+        /// This is used when the output or one of the tensors in the
+        /// expression has a tiled layout. Square tiles keep both a tile and
+        /// its transpose in cache, e.g., for A(i,j) + A(j,i).
+        static constexpr void _assign_tiled(A& a, B const& b, std::array<std::size_t, 2> tile)
+        {
+            auto const m = extent<0>(a);
+            auto const n = extent<1>(a);
+            for (std::size_t i0 = 0; i0 < m; i0 += tile[0]) {
+                auto const i1 = std::min(i0 + tile[0], m);
+                for (std::size_t j0 = 0; j0 < n; j0 += tile[1]) {
+                    auto const j1 = std::min(j0 + tile[1], n);
+                    for (std::size_t i = i0; i != i1; ++i) {
+                        for (std::size_t j = j0; j != j1; ++j) {
+                            evaluate(a, i, j) = _evaluate_as(b, i, j);
+                        }
+                    }
+                }
+            }
+        }
+
+        /// Assign a random tensor, e.g., A(i,j) = R(i,j).
+        ///
+        /// Each row along the innermost index is generated in batches of
+        /// consecutive elements. The elements are independent, so the rows are
+        /// assigned in parallel.
+        static constexpr void _assign_random(A& a, B const& b)
+        {
+            using T = typename _::is_bind<std::remove_cvref_t<B>>::tensor_type::value_type;
+            static constexpr std::size_t R = rank<A>;
+            static constexpr std::size_t batch = 64;
+
+            auto const& r = b._a;
+            auto const e = ttl::extents(a);
+            auto const n = e.extent(R - 1);
+
+            auto const row = [&](auto... i) {
+                std::size_t offset = 0;
+                if constexpr (sizeof...(i) != 0) {
+                    std::size_t const ind[] { std::size_t(i)... };
+                    for (std::size_t k = 0; k < R - 1; ++k) {
+                        offset = offset * e.extent(k) + ind[k];
+                    }
+                }
+                T buffer[batch] {};
+                for (std::size_t j0 = 0; j0 < n; j0 += batch) {
+                    auto const m = std::min(batch, n - j0);
+                    r.generate(offset * n + j0, std::span(buffer, m));
+                    for (std::size_t j = 0; j != m; ++j) {
+                        evaluate(a, i..., j0 + j) = buffer[j];
+                    }
+                }
+            };
+
+            if constexpr (R == 1) {
+                row();
+            }
+            else {
+                auto const prefix = select_extents(std::make_index_sequence<R - 1>(), e);
+                std::size_t nt = 1;
+                if !consteval {
+                    std::size_t size = 1;
+                    for (std::size_t k = 0; k < R; ++k) {
+                        size *= e.extent(k);
+                    }
+                    nt = std::min(parallel_threads(size), e.extent(0));
+                }
+                parallel_for(nt, [&](std::size_t t) {
+                    for (std::size_t m = e.extent(0) * t / nt, end = e.extent(0) * (t + 1) / nt; m != end; ++m) {
+                        _for_each_slice<0>(prefix, m, row);
+                    }
+                });
+            }
+        }
+
+        /// Assign an outer product, e.g., C(i,j) = x(i) * y(j).
+        ///
+        /// The generic evaluation re-evaluates the left factor for every
+        /// element of the right. Here we evaluate it once and hold it while we
+        /// stream across the right factor. The combined value is passed through
+        /// `f(v, i...)` along with the output index, which lets rank-1 updates
+        /// like C(i,j) + x(i) * y(j) fuse their read of C into the same pass.
+        static constexpr void _assign_outer(A& a, auto const& p, auto const& f)
+        {
+            using P = std::remove_cvref_t<decltype(p)>;
+            bool const stream = _use_streaming_stores(a);
+            _::for_each_index(ttl::extents(p._a), [&](auto... i) {
+                auto const u = evaluate(p._a, i...);
+                _::for_each_index(ttl::extents(p._b), [&](auto... j) {
+                    _store(stream, evaluate(a, i..., j...), f(P::_op(u, evaluate(p._b, j...)), i..., j...));
+                });
+            });
+            if (stream) {
+                _store_fence();
+            }
+        }
+
+        /// Check to see if the output is large enough to bypass the cache.
+        static constexpr bool _use_streaming_stores(A const& a)
+        {
+            auto const e = ttl::extents(a);
+            std::size_t n = sizeof(scalar_type<A>);
+            for (std::size_t i = 0; i < e.rank(); ++i) {
+                n *= e.extent(i);
+            }
+            return n > TTL_STREAMING_STORE_BYTES;
+        }
+
+        /// Store `v` into `c`, using a non-temporal store if requested and
+        /// possible.
+        static constexpr void _store(bool stream, auto&& c, auto const& v)
+        {
+#if __has_builtin(__builtin_nontemporal_store)
+            using T = std::remove_reference_t<decltype(c)>;
+            if constexpr (std::is_lvalue_reference_v<decltype(c)> and std::is_arithmetic_v<T> and not std::is_const_v<T>) {
+                if !consteval {
+                    if (stream) {
+                        __builtin_nontemporal_store(static_cast<T>(v), std::addressof(c));
+                        return;
+                    }
+                }
+            }
+#endif
+            (void)stream;
+            __fwd(c) = v;
+        }
+
+        /// Order any non-temporal stores before subsequent stores.
+        static constexpr void _store_fence()
+        {
+#if __has_builtin(__builtin_ia32_sfence)
+            if !consteval {
+                __builtin_ia32_sfence();
+            }
+#endif
+        }
+
+        /// Invoke `f(i...)` for every non-increasing index of rank `N` with
+        /// extent `n`.
+        template <std::size_t N>
+        static constexpr void _for_each_packed(std::size_t n, auto const& f, std::integral auto... i)
+        {
+            if constexpr (sizeof...(i) == N) {
+                f(i...);
+            }
+            else {
+                std::size_t const ind[] { n - 1, std::size_t(i)... };
+                for (std::size_t j = 0, e = ind[sizeof...(i)] + 1; j != e; ++j) {
+                    _for_each_packed<N>(n, f, i..., j);
+                }
+            }
+        }
+
+        /// Assign to a packed symmetric tensor.
+        ///
+        /// Every permutation of an index refers to the same element, so we
+        /// only evaluate and write each stored element once.
+        static constexpr void _assign_packed_symmetric(A& a, B const& b)
+        {
+            _for_each_packed<rank<A>>(extent<0>(a), [&](auto... i) {
+                evaluate(a, i...) = _evaluate_as(b, i...);
+            });
+        }
+
+        /// Assign to a packed triangular matrix.
+        ///
+        /// Only the stored triangle is evaluated and written.
+        static constexpr void _assign_packed_triangular(A& a, B const& b)
+        {
+            static constexpr bool lower = _triangle() == triangle::lower;
+            auto const n = extent<0>(a);
+            for (std::size_t i = 0; i != n; ++i) {
+                auto const begin = lower ? 0 : i;
+                auto const end = lower ? i + 1 : n;
+                for (std::size_t j = begin; j != end; ++j) {
+                    evaluate(a, i, j) = _evaluate_as(b, i, j);
+                }
+            }
+        }
+
+        /// Assign to a Voigt tensor.
+        ///
+        /// Only one representative of each stored element is evaluated and
+        /// written.
+        static constexpr void _assign_voigt(A& a, B const& b)
+        {
+            using L = typename _::is_bind<std::remove_cvref_t<A>>::tensor_type::layout_type;
+            auto const n = extent<0>(a);
+            auto const m = L::size(n);
+            for (std::size_t v = 0; v != m; ++v) {
+                auto const [i, j] = L::pair(n, v);
+                if constexpr (rank<A> == 2) {
+                    evaluate(a, i, j) = _evaluate_as(b, i, j);
+                }
+                else {
+                    for (std::size_t w = 0, e = L::packed ? v + 1 : m; w != e; ++w) {
+                        auto const [k, l] = L::pair(n, w);
+                        evaluate(a, i, j, k, l) = _evaluate_as(b, i, j, k, l);
+                    }
+                }
+            }
+        }
+
+        /// Assign a symmetric rank-2 product, e.g., A(i,k) * A(j,k).
+        ///
+        /// Only the lower triangle of the product is evaluated, and each value
+        /// is mirrored across the diagonal. Since the result is symmetric we
+        /// don't need to care about how `a` orders its outer indices.
+        static constexpr void _assign_symmetric(A& a, B const& b)
+        {
+            auto const n = extent<0>(b);
+            for (auto i = 0zu; i != n; ++i) {
+                for (auto j = 0zu; j != i; ++j) {
+                    auto const v = evaluate(b, i, j);
+                    evaluate(a, i, j) = v;
+                    evaluate(a, j, i) = v;
+                }
+                evaluate(a, i, i) = evaluate(b, i, i);
+            }
+        }
+
         /// Perform the inner contraction when A and B are expressions.
         template <std::size_t... i, std::size_t... j, std::integral... Ks>
         static constexpr void _assign(A& a, B const& b, std::index_sequence<i...>, std::index_sequence<j...>, Ks... k)
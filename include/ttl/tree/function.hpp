@@ -0,0 +1,155 @@
+#pragma once
+
+#include <ttl/evaluate.hpp>
+#include <ttl/extents.hpp>
+#include <ttl/math.hpp>
+#include <ttl/outer.hpp>
+#include <ttl/tensor.hpp>
+#include <ttl/tree/node.hpp>
+#include <ttl/tree/product.hpp>
+#include <ttl/tree/sum.hpp>
+
+#include <concepts>
+#include <functional>
+#include <type_traits>
+
+namespace ttl::tree
+{
+    /// A node that applies a scalar function, op(A), to each element.
+    ///
+    /// Unlike the unary prefix operators, the scalar type is the result of the
+    /// function, e.g., sqrt(A(i)) is a double for an integer A.
+    template <expression A, auto op>
+    struct unary_function : node {
+        using scalar_type = std::remove_cvref_t<std::invoke_result_t<decltype(op), ttl::evaluate_type<A>>>;
+
+        static constexpr auto _op = op;
+
+        /// This node type with another child, e.g., for rewriting.
+        template <class X>
+        using _rebuild = unary_function<X, op>;
+
+        A _a;
+
+        constexpr unary_function(A a)
+            : _a(__fwd(a))
+        {
+        }
+
+        static constexpr auto outer()
+        {
+            return ttl::outer<A>;
+        }
+
+        constexpr auto extents() const
+        {
+            return ttl::extents(_a);
+        }
+
+        constexpr auto operator[](this auto&& self, std::integral auto... i) -> scalar_type
+        {
+            static_assert(sizeof...(i) == ttl::rank<A>);
+            assert(self._check_bounds(i...));
+            return op(ttl::evaluate(__fwd(self)._a, i...));
+        }
+    };
+
+    template <expression A>
+    struct exp : unary_function<A, math::exp> {
+        using exp::unary_function::unary_function;
+    };
+
+    template <expression A>
+    struct log : unary_function<A, math::log> {
+        using log::unary_function::unary_function;
+    };
+
+    template <expression A>
+    struct sqrt : unary_function<A, math::sqrt> {
+        using sqrt::unary_function::unary_function;
+    };
+
+    template <expression A>
+    struct abs : unary_function<A, math::abs> {
+        using abs::unary_function::unary_function;
+    };
+
+    /// Apply a binary scalar function element-wise.
+    ///
+    /// If one side is a scalar it is broadcast with an outer product node that
+    /// applies op instead of multiplying (e.g., max(A(i), 0)), otherwise the
+    /// outer indices of both sides must be a permutation of each other and we
+    /// use a sum node that applies op (e.g., pow(A(i,j), B(j,i))).
+    template <auto op, expression A, expression B>
+    inline constexpr auto elementwise(A&& a, B&& b)
+    {
+        if constexpr (rank<A> == 0 or rank<B> == 0) {
+            return product<A, B, op, std::plus {}>(__fwd(a), __fwd(b));
+        }
+        else {
+            return sum<A, B, op>(__fwd(a), __fwd(b));
+        }
+    }
+
+    /// The expressions that the element-wise functions accept.
+    ///
+    /// We only match tree nodes, so that the functions don't capture calls on
+    /// plain numbers.
+    template <class T>
+    concept function_argument = expression<T> and std::derived_from<std::remove_cvref_t<T>, node>;
+}
+
+namespace ttl
+{
+    /// Element-wise e^x, e.g., y(i) = exp(x(i)) * A(i,j) * z(j).
+    template <tree::function_argument A>
+    inline constexpr auto exp(A&& a) -> tree::exp<A>
+    {
+        return tree::exp<A>(__fwd(a));
+    }
+
+    /// Element-wise natural logarithm.
+    template <tree::function_argument A>
+    inline constexpr auto log(A&& a) -> tree::log<A>
+    {
+        return tree::log<A>(__fwd(a));
+    }
+
+    /// Element-wise square root.
+    template <tree::function_argument A>
+    inline constexpr auto sqrt(A&& a) -> tree::sqrt<A>
+    {
+        return tree::sqrt<A>(__fwd(a));
+    }
+
+    /// Element-wise absolute value.
+    template <tree::function_argument A>
+    inline constexpr auto abs(A&& a) -> tree::abs<A>
+    {
+        return tree::abs<A>(__fwd(a));
+    }
+
+    /// Element-wise power, e.g., pow(A(i,j), 2) or pow(A(i,j), B(j,i)).
+    template <expression A, expression B>
+        requires(tree::function_argument<A> or tree::function_argument<B>)
+    inline constexpr auto pow(A&& a, B&& b)
+    {
+        return tree::elementwise<math::pow>(__fwd(a), __fwd(b));
+    }
+
+    /// Element-wise minimum, e.g., min(A(i,j), A(j,i)).
+    template <expression A, expression B>
+        requires(tree::function_argument<A> or tree::function_argument<B>)
+    inline constexpr auto min(A&& a, B&& b)
+    {
+        return tree::elementwise<tree::minimum {}>(__fwd(a), __fwd(b));
+    }
+
+    /// Element-wise maximum, e.g., max(x(i), 0.0).
+    template <expression A, expression B>
+        requires(tree::function_argument<A> or tree::function_argument<B>)
+    inline constexpr auto max(A&& a, B&& b)
+    {
+        return tree::elementwise<tree::maximum {}>(__fwd(a), __fwd(b));
+    }
+}
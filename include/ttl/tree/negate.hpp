@@ -8,14 +8,26 @@
 
 #include <concepts>
 #include <functional>
+#include <type_traits>
 
 namespace ttl::tree
 {
     template <expression A, auto op>
     struct unary_prefix : node {
+        using scalar_type = std::remove_cvref_t<std::invoke_result_t<decltype(op), ttl::evaluate_type<A>>>;
+
+        /// This node type with another child, e.g., for rewriting.
+        template <class X>
+        using _rebuild = unary_prefix<X, op>;
+
         A _a;
 
-        constexpr operator ttl::evaluate_type<A>(this auto&& self)
+        constexpr unary_prefix(A a)
+            : _a(__fwd(a))
+        {
+        }
+
+        constexpr operator scalar_type(this auto&& self)
             requires(ttl::rank<A> == 0)
         {
             return __fwd(self)[];
@@ -31,7 +43,7 @@ namespace ttl::tree
             return ttl::extents(_a);
         }
 
-        constexpr auto operator[](this auto&& self, std::integral auto... i) -> ttl::evaluate_type<A>
+        constexpr auto operator[](this auto&& self, std::integral auto... i) -> scalar_type
         {
             static_assert(sizeof...(i) == ttl::rank<A>);
             assert(self._check_bounds(i...));
@@ -2,10 +2,15 @@
 
 #include <ttl/extents.hpp>
 #include <ttl/index.hpp>
+#include <ttl/outer.hpp>
 
+#include <algorithm>
 #include <concepts>
 #include <cstddef>
 #include <mdspan>
+#include <memory>
+#include <ranges>
+#include <type_traits>
 #include <utility>
 
 namespace ttl::tree
@@ -13,6 +18,101 @@ namespace ttl::tree
     template <tensor, index_string>
     struct bind;
 
+    namespace _
+    {
+        template <class>
+        struct is_bind : std::false_type {
+        };
+
+        /// Expose the bound tensor type and index for bind nodes, so that
+        /// other nodes can pattern match on their children.
+        template <class A, index_string _index>
+        struct is_bind<bind<A, _index>> : std::true_type {
+            using tensor_type = std::remove_cvref_t<A>;
+            static constexpr auto index = _index;
+        };
+    }
+
+    template <class T>
+    concept is_bind = _::is_bind<std::remove_cvref_t<T>>::value;
+
+    struct node;
+
+    namespace _
+    {
+        /// The indices that `T` binds to the shifted slots of shifted views
+        /// (see `ttl::shifted`), renamed through any rebinds.
+        template <class T>
+        inline constexpr auto shifted_indices = [] {
+            using U = std::remove_cvref_t<T>;
+            if constexpr (tree::is_bind<U>) {
+                using X = typename is_bind<U>::tensor_type;
+                constexpr auto index = is_bind<U>::index;
+                std::remove_const_t<decltype(index)> out;
+                std::size_t m = 0;
+                if constexpr (requires { X::shifted_slots; }) {
+                    for (std::size_t n = 0; n < index.size(); ++n) {
+                        if (X::shifted_slots >> n & 1) {
+                            out._data[m++] = index[n];
+                        }
+                    }
+                }
+                else if constexpr (std::derived_from<X, node>) {
+                    constexpr auto from = ttl::outer<X>;
+                    for (char const c : shifted_indices<X>) {
+                        out._data[m++] = index[from.index_of(c)];
+                    }
+                }
+                return out;
+            }
+            else if constexpr (std::derived_from<U, node> and requires(U const& u) { u._a; u._b; }) {
+                return shifted_indices<decltype(U::_a)> + shifted_indices<decltype(U::_b)>;
+            }
+            else if constexpr (std::derived_from<U, node> and requires(U const& u) { u._a; }) {
+                return shifted_indices<decltype(U::_a)>;
+            }
+            else {
+                return index_string {};
+            }
+        }();
+
+        /// Check to see if none of the shifted indices of `T...` are
+        /// contracted in `index`, which is how products and binds reject
+        /// contractions over offset indices, e.g., x(i+1) * y(i).
+        template <index_string index, class... T>
+        inline constexpr bool shifted_indices_free = [] {
+            auto const free = [](auto const& str) {
+                return std::ranges::all_of(str, [](char const c) {
+                    return index.count(c) == 1;
+                });
+            };
+            return (free(shifted_indices<T>) and ...);
+        }();
+    }
+
+    /// Check to see if two leaf tensors refer to the same storage.
+    ///
+    /// Leaves are frequently bound by value (e.g., the mdspan copies made by
+    /// tspan), so we can't just compare addresses. Mdspans compare their data
+    /// handles and mappings, contiguous ranges compare their data and size, and
+    /// everything else falls back to the address of the leaf.
+    template <class A, class B>
+    inline constexpr bool same_tensor(A const& a, B const& b)
+    {
+        if constexpr (not std::same_as<A, B>) {
+            return false;
+        }
+        else if constexpr (requires { a.data_handle(); a.mapping(); }) {
+            return a.data_handle() == b.data_handle() and a.mapping() == b.mapping();
+        }
+        else if constexpr (std::ranges::contiguous_range<A const> and std::ranges::sized_range<A const>) {
+            return std::ranges::data(a) == std::ranges::data(b) and std::ranges::size(a) == std::ranges::size(b);
+        }
+        else {
+            return std::addressof(a) == std::addressof(b);
+        }
+    }
+
     struct node {
         /// Rebind an expression. This is implemented in bind.hpp in order to
         /// break the circular include there.
@@ -2,17 +2,138 @@
 
 #include <ttl/evaluate.hpp>
 #include <ttl/index.hpp>
+#include <ttl/layout.hpp>
 #include <ttl/outer.hpp>
 #include <ttl/tensor.hpp>
 #include <ttl/tree/node.hpp>
 
+#include <algorithm>
 #include <concepts>
 #include <cstddef>
 #include <functional>
+#include <limits>
 #include <type_traits>
+#include <vector>
 
 namespace ttl::tree
 {
+    /// A bind of a rank-2 tensor to two distinct indices, e.g., A(i,j).
+    template <class T>
+    concept matrix_bind = is_bind<T>
+        and _::is_bind<std::remove_cvref_t<T>>::index.size() == 2
+        and _::is_bind<std::remove_cvref_t<T>>::index.outer().size() == 2;
+
+    /// A bind of a compressed sparse matrix to two distinct indices (see
+    /// `ttl::sparse_span`).
+    template <class T>
+    concept sparse_bind = matrix_bind<T> and requires(typename _::is_bind<std::remove_cvref_t<T>>::tensor_type const& t) {
+        _::is_bind<std::remove_cvref_t<T>>::tensor_type::major_slot;
+        t.offsets();
+        t.indices();
+        t.values();
+    };
+
+    namespace _
+    {
+        /// A bound on a contracted index, relative to the index at `p` (see
+        /// `product::_triangular_bound` and `product::_diagonal_bound`).
+        struct contraction_bound {
+            bool active = false;
+            std::size_t p = 0;
+            bool upper = false;
+        };
+
+        /// The positions of the other indices of a permutation tensor, whose
+        /// values determine the value of a contracted index (see
+        /// `product::_levi_civita_bound`).
+        struct permutation_bound {
+            bool active = false;
+            std::size_t others = 0;
+            std::size_t p[2] {};
+        };
+    }
+
+    /// A bind of a packed symmetric tensor to distinct indices (see
+    /// `ttl::layout_packed_symmetric`).
+    template <class T>
+    concept symmetric_bind = is_bind<T>
+        and packed_symmetric<typename _::is_bind<std::remove_cvref_t<T>>::tensor_type>
+        and _::is_bind<std::remove_cvref_t<T>>::index.outer().size() == _::is_bind<std::remove_cvref_t<T>>::index.size();
+
+    /// A bind of a packed triangular matrix to two distinct indices (see
+    /// `ttl::layout_packed_triangular`).
+    template <class T>
+    concept triangular_bind = matrix_bind<T> and packed_triangular<typename _::is_bind<std::remove_cvref_t<T>>::tensor_type>;
+
+    /// A bind of a Voigt tensor to distinct indices (see `ttl::layout_voigt`).
+    template <class T>
+    concept voigt_bind = is_bind<T>
+        and voigt<typename _::is_bind<std::remove_cvref_t<T>>::tensor_type>
+        and _::is_bind<std::remove_cvref_t<T>>::index.outer().size() == _::is_bind<std::remove_cvref_t<T>>::index.size();
+
+    /// A bind of a diagonal matrix to two distinct indices (see
+    /// `ttl::kronecker_delta` and `ttl::diagonal_matrix`).
+    template <class T>
+    concept diagonal_bind = matrix_bind<T> and requires {
+        requires _::is_bind<std::remove_cvref_t<T>>::tensor_type::is_diagonal;
+    };
+
+    /// A bind of a Levi-Civita tensor to distinct indices (see
+    /// `ttl::levi_civita`).
+    template <class T>
+    concept levi_civita_bind = is_bind<T>
+        and requires { requires _::is_bind<std::remove_cvref_t<T>>::tensor_type::is_levi_civita; }
+        and _::is_bind<std::remove_cvref_t<T>>::index.outer().size() == _::is_bind<std::remove_cvref_t<T>>::index.size();
+
+    /// A bind of a constant tensor to distinct indices (see
+    /// `ttl::constant_tensor`).
+    template <class T>
+    concept constant_bind = is_bind<T>
+        and requires { requires _::is_bind<std::remove_cvref_t<T>>::tensor_type::is_constant; }
+        and _::is_bind<std::remove_cvref_t<T>>::index.outer().size() == _::is_bind<std::remove_cvref_t<T>>::index.size();
+
+    /// A reduction that selects the smaller value, with +infinity (or the
+    /// largest value) as its identity.
+    struct minimum {
+        template <class T>
+        static constexpr auto identity() -> T
+        {
+            if constexpr (std::numeric_limits<T>::has_infinity) {
+                return std::numeric_limits<T>::infinity();
+            }
+            else {
+                return std::numeric_limits<T>::max();
+            }
+        }
+
+        template <class T, class U>
+        constexpr auto operator()(T const& a, U const& b) const -> std::common_type_t<T, U>
+        {
+            return (b < a) ? b : a;
+        }
+    };
+
+    /// A reduction that selects the larger value, with -infinity (or the
+    /// lowest value) as its identity.
+    struct maximum {
+        template <class T>
+        static constexpr auto identity() -> T
+        {
+            if constexpr (std::numeric_limits<T>::has_infinity) {
+                return -std::numeric_limits<T>::infinity();
+            }
+            else {
+                return std::numeric_limits<T>::lowest();
+            }
+        }
+
+        template <class T, class U>
+        constexpr auto operator()(T const& a, U const& b) const -> std::common_type_t<T, U>
+        {
+            return (a < b) ? b : a;
+        }
+    };
+
     template <expression A, expression B, auto op, auto reduce>
     struct product : node {
         using scalar_type = std::invoke_result_t<decltype(op), scalar_type<A>, scalar_type<B>>;
@@ -23,18 +144,280 @@ namespace ttl::tree
         static constexpr auto _outer_ab = _outer_a + _outer_b;
 
         static_assert(_outer_ab.projected().size() == 0);
+        static_assert(_::shifted_indices_free<_outer_ab, A, B>, "Offset indices can't be contracted.");
 
         static constexpr auto _outer = _outer_ab.outer();
         static constexpr auto _inner = _outer_ab.inner();
         static constexpr auto _rank = _outer.rank();
 
+        static constexpr auto _op = op;
+        static constexpr auto _reduce = reduce;
+
+        /// This node type with other children, e.g., for rewriting.
+        template <class X, class Y>
+        using _rebuild = product<X, Y, op, reduce>;
+
         /// Index maps for the inner evaluate.
         static constexpr auto _map_a = index_map<_inner, _outer_a>;
         static constexpr auto _map_b = index_map<_inner, _outer_b>;
 
+        /// Check to see if this is a tensor multiplied by itself, where the two
+        /// bindings differ only in a single outer slot, e.g., A(i,k) * A(j,k).
+        ///
+        /// Such a product is symmetric in its two outer indices. This is only
+        /// the structural check, `_is_symmetric()` verifies that both sides
+        /// actually bind the same storage.
+        static constexpr bool _symmetric_pattern = [] {
+            using TA = _::is_bind<std::remove_cvref_t<A>>;
+            using TB = _::is_bind<std::remove_cvref_t<B>>;
+            if constexpr (not TA::value or not TB::value or _rank != 2) {
+                return false;
+            }
+            else if constexpr (not std::same_as<typename TA::tensor_type, typename TB::tensor_type>) {
+                return false;
+            }
+            else {
+                constexpr auto x = TA::index;
+                constexpr auto y = TB::index;
+                if (x.size() != y.size() or x.count(projected_index) or y.count(projected_index)) {
+                    return false;
+                }
+                int n = 0;
+                for (std::size_t i = 0; i < x.size(); ++i) {
+                    if (x[i] != y[i]) {
+                        if (_outer.count(x[i]) != 1 or _outer.count(y[i]) != 1) {
+                            return false;
+                        }
+                        n += 1;
+                    }
+                }
+                return n == 1;
+            }
+        }();
+
+        /// Check to see if this product uses ordinary multiplication, so that
+        /// zero elements of either operand annihilate their terms.
+        static constexpr bool _multiplicative = std::same_as<decltype(op), std::multiplies<>> and std::same_as<decltype(reduce), std::plus<>>;
+
+        /// Check to see if one of the operands is a constant, e.g.,
+        /// A(i,j) * ones(j).
+        ///
+        /// Multiplication distributes over the reduction, so we can reduce
+        /// the other operand and multiply by the constant once.
+        static constexpr bool _constant_pattern = _multiplicative and (constant_bind<A> or constant_bind<B>);
+
+        /// Check to see if this is a matrix product, e.g., A(i,k) * B(k,j).
+        static constexpr bool _matrix_pattern = _rank == 2 and matrix_bind<A> and matrix_bind<B>;
+
+        /// Check to see if this is the trace of a matrix product, e.g.,
+        /// A(i,j) * B(j,i) or A(i,j) * B(i,j).
+        static constexpr bool _trace_pattern = _rank == 0 and matrix_bind<A> and matrix_bind<B>;
+
+        /// Check to see if this is the trace of a chain of three matrices,
+        /// e.g., A(i,j) * B(j,k) * C(k,i).
+        ///
+        /// The inner product must use the same operations as we do, otherwise
+        /// we can't reassociate the chain.
+        static constexpr bool _trace_chain_pattern = [] {
+            using Q = std::remove_cvref_t<A>;
+            if constexpr (_rank != 0 or not matrix_bind<B> or not requires { Q::_matrix_pattern; }) {
+                return false;
+            }
+            else {
+                return Q::_matrix_pattern
+                    and std::same_as<decltype(Q::_op), decltype(_op)>
+                    and std::same_as<decltype(Q::_reduce), decltype(_reduce)>;
+            }
+        }();
+
+        /// Check to see if `V` is a rank-4 Voigt tensor and this product
+        /// contracts one of its symmetric pairs with the rank-2 tensor `E`,
+        /// e.g., C(i,j,k,l) * e(k,l).
+        template <class V, class E>
+        static constexpr bool _voigt_contraction = [] {
+            if constexpr (not voigt_bind<V> or not matrix_bind<E> or rank<V> != 4) {
+                return false;
+            }
+            else {
+                constexpr auto x = _::is_bind<std::remove_cvref_t<V>>::index;
+                constexpr auto y = _::is_bind<std::remove_cvref_t<E>>::index;
+                constexpr auto c = _outer_ab.contracted();
+                return c.size() == 2 and is_permutation(c, y) and x.index_of(y[0]) / 2 == x.index_of(y[1]) / 2;
+            }
+        }();
+
+        /// Check to see if this is a Voigt contraction (see
+        /// `_voigt_contraction`), with the Voigt tensor on either side.
+        ///
+        /// The minor symmetry of the rank-4 tensor means that we only need to
+        /// visit its m = n(n+1)/2 distinct pairs, combining each off-diagonal
+        /// coefficient with both e(k,l) and e(l,k).
+        static constexpr bool _voigt_pattern = _voigt_contraction<A, B> or _voigt_contraction<B, A>;
+
+        /// Check to see if this is an outer product, i.e., there are no
+        /// contracted indices, e.g., x(i) * y(j) or 2 * A(i,j).
+        static constexpr bool _outer_pattern = _outer_ab.contracted().size() == 0;
+
+        /// Check to see if `S` is a sparse matrix bind whose major (or minor)
+        /// slot is the only index that this product contracts.
+        template <class S, bool major>
+        static constexpr bool _sparse_contraction = [] {
+            if constexpr (not sparse_bind<S>) {
+                return false;
+            }
+            else {
+                using T = _::is_bind<std::remove_cvref_t<S>>;
+                constexpr auto c = _outer_ab.contracted();
+                constexpr auto s = T::tensor_type::major_slot;
+                return c.size() == 1 and c[0] == T::index[major ? s : 1 - s];
+            }
+        }();
+
+        /// Check to see if this is a sparse-dense product that contracts the
+        /// sparse matrix's minor slot, e.g., A(i,j) * x(j) for a CSR matrix A.
+        ///
+        /// Each value of the major slot then only needs to visit the nonzeros
+        /// stored in its slice.
+        static constexpr bool _sparse_gather = _sparse_contraction<A, false> or _sparse_contraction<B, false>;
+
+        /// Check to see if this is a sparse-dense product that contracts the
+        /// sparse matrix's major slot, e.g., A(i,j) * x(j) for a CSC matrix A.
+        ///
+        /// This can't be evaluated one element at a time, but an assignment
+        /// can scatter each nonzero into the output.
+        static constexpr bool _sparse_scatter = not _sparse_gather and (_sparse_contraction<A, true> or _sparse_contraction<B, true>);
+
+        /// Is the sparse operand on the left?
+        static constexpr bool _sparse_left = _sparse_contraction<A, false> or (not _sparse_gather and _sparse_contraction<A, true>);
+
+        /// The slot in the outer index of the sparse matrix's uncontracted
+        /// index.
+        static constexpr std::size_t _sparse_slot = [] {
+            if constexpr (not _sparse_gather and not _sparse_scatter) {
+                return 0zu;
+            }
+            else {
+                using T = _::is_bind<std::remove_cvref_t<std::conditional_t<_sparse_left, A, B>>>;
+                return _outer.index_of(T::index[_outer_ab.contracted()[0] == T::index[0] ? 1 : 0]);
+            }
+        }();
+
+        /// The range of the `N`th inner index that can be nonzero because of a
+        /// triangular operand.
+        ///
+        /// If the index is bound to one slot of a packed triangular matrix,
+        /// and its other slot is bound to an index `p` < `N` that we've
+        /// already fixed, then the contraction can stop at (or start from)
+        /// the diagonal. This relies on zero annihilating the product, so it
+        /// only applies to ordinary multiplication.
+        template <std::size_t N>
+        static constexpr auto _triangular_bound = [] {
+            _::contraction_bound out;
+
+            if constexpr (_multiplicative) {
+                auto const check = [&]<class T>(std::type_identity<T>) {
+                    if constexpr (triangular_bind<T>) {
+                        constexpr auto x = _::is_bind<std::remove_cvref_t<T>>::index;
+                        constexpr bool lower = _::is_bind<std::remove_cvref_t<T>>::tensor_type::layout_type::stored == triangle::lower;
+                        for (std::size_t s = 0; s < 2; ++s) {
+                            if (not out.active and x[s] == _inner[N] and _inner.index_of(x[1 - s]) < N) {
+                                out.active = true;
+                                out.p = _inner.index_of(x[1 - s]);
+                                out.upper = ((s == 1) == lower);
+                            }
+                        }
+                    }
+                };
+                check(std::type_identity<A>());
+                check(std::type_identity<B>());
+            }
+            return out;
+        }();
+
+        /// The value of the `N`th inner index when it is fixed by a diagonal
+        /// operand.
+        ///
+        /// If the index is bound to one slot of a diagonal matrix and its
+        /// other slot is bound to an index `p` < `N` that we've already fixed,
+        /// then only the term where the two are equal can be nonzero, so the
+        /// contraction is just a rename, e.g., delta(i,j) * A(j,k) is A(i,k).
+        template <std::size_t N>
+        static constexpr auto _diagonal_bound = [] {
+            _::contraction_bound out;
+
+            if constexpr (_multiplicative) {
+                auto const check = [&]<class T>(std::type_identity<T>) {
+                    if constexpr (diagonal_bind<T>) {
+                        constexpr auto x = _::is_bind<std::remove_cvref_t<T>>::index;
+                        for (std::size_t s = 0; s < 2; ++s) {
+                            if (not out.active and x[s] == _inner[N] and _inner.index_of(x[1 - s]) < N) {
+                                out.active = true;
+                                out.p = _inner.index_of(x[1 - s]);
+                            }
+                        }
+                    }
+                };
+                check(std::type_identity<A>());
+                check(std::type_identity<B>());
+            }
+            return out;
+        }();
+
+        /// The other indices of a permutation tensor that determine the
+        /// `N`th inner index.
+        ///
+        /// If the index is bound to one slot of a Levi-Civita tensor and all
+        /// of its other slots are bound to indices < `N` that we've already
+        /// fixed, then at most one value of the index gives a nonzero term,
+        /// e.g., in epsilon(i,j,k) * a(j) the only term for (i,k) is
+        /// j = 3 - i - k, if i and k differ.
+        template <std::size_t N>
+        static constexpr auto _levi_civita_bound = [] {
+            _::permutation_bound out;
+
+            if constexpr (_multiplicative) {
+                auto const check = [&]<class T>(std::type_identity<T>) {
+                    if constexpr (levi_civita_bind<T>) {
+                        constexpr auto x = _::is_bind<std::remove_cvref_t<T>>::index;
+                        if (out.active or x.count(_inner[N]) == 0) {
+                            return;
+                        }
+                        std::size_t n = 0;
+                        for (std::size_t s = 0; s < x.size(); ++s) {
+                            if (x[s] != _inner[N]) {
+                                if (_inner.index_of(x[s]) >= N) {
+                                    return;
+                                }
+                                out.p[n++] = _inner.index_of(x[s]);
+                            }
+                        }
+                        out.active = true;
+                        out.others = n;
+                    }
+                };
+                check(std::type_identity<A>());
+                check(std::type_identity<B>());
+            }
+            return out;
+        }();
+
         A _a;
         B _b;
 
+        /// The identity of the reduction, which seeds every accumulation.
+        ///
+        /// Reductions can provide it as `identity<T>()`, otherwise we use a
+        /// value-initialized accumulator, which is right for plus and or.
+        static constexpr auto _identity() -> accumulator_type
+        {
+            if constexpr (requires { decltype(reduce)::template identity<accumulator_type>(); }) {
+                return decltype(reduce)::template identity<accumulator_type>();
+            }
+            else {
+                return accumulator_type {};
+            }
+        }
+
         constexpr product(A a, B b)
             : _a(__fwd(a))
             , _b(__fwd(b))
@@ -61,10 +444,238 @@ namespace ttl::tree
         {
             static_assert(sizeof...(i) == _rank);
             assert(_check_bounds(i...));
-            return _evaluate(i...);
+            if constexpr (_multiplicative) {
+                if (_structural_zero<A>(i...) or _structural_zero<B>(i...)) {
+                    return accumulator_type {};
+                }
+            }
+            if constexpr (_constant_pattern) {
+                return _constant_evaluate(i...);
+            }
+            else if constexpr (_trace_pattern) {
+                return _trace();
+            }
+            else if constexpr (_trace_chain_pattern) {
+                return _trace_chain();
+            }
+            else if constexpr (_sparse_gather) {
+                return _sparse_evaluate(i...);
+            }
+            else if constexpr (_voigt_pattern) {
+                return _voigt_evaluate(i...);
+            }
+            else {
+                return _evaluate(i...);
+            }
+        }
+
+        /// Check to see if this product is symmetric in its outer indices.
+        ///
+        /// The assignment engine uses this to evaluate only one triangle of the
+        /// result.
+        constexpr bool _is_symmetric() const
+        {
+            if constexpr (_symmetric_pattern) {
+                return same_tensor(_a._a, _b._a);
+            }
+            else {
+                return false;
+            }
+        }
+
+        /// The sparse matrix in a sparse-dense product.
+        constexpr auto const& _sparse() const
+            requires(_sparse_gather or _sparse_scatter)
+        {
+            if constexpr (_sparse_left) {
+                return _a._a;
+            }
+            else {
+                return _b._a;
+            }
+        }
+
+        /// Combine a sparse nonzero `v` with the dense operand evaluated at
+        /// the inner index i..., in the right operand order.
+        constexpr auto _sparse_combine(auto const& v, std::integral auto... i) const -> scalar_type
+            requires(_sparse_gather or _sparse_scatter)
+        {
+            static_assert(sizeof...(i) == _inner.size());
+            if constexpr (_sparse_left) {
+                return op(v, _evaluate_at(_b, _map_b, i...));
+            }
+            else {
+                return op(_evaluate_at(_a, _map_a, i...), v);
+            }
+        }
+
+        /// The extents of the inner index space, i.e., the outer indices
+        /// followed by the contracted indices.
+        constexpr auto _inner_extents() const
+        {
+            return select_extents(index_map<_outer_ab, _inner>, _extents_ab());
+        }
+
+        /// Evaluate the single term of the reduction at the inner index i...,
+        /// without reducing (see `ttl::assign_all`).
+        constexpr auto _term(std::integral auto... i) const -> scalar_type
+        {
+            static_assert(sizeof...(i) == _inner.size());
+            return _evaluate(_map_a, _map_b, i...);
         }
 
     private:
+        /// Check to see if the outer index i... selects a structural zero of
+        /// the operand `T`, i.e., an off-diagonal element of a diagonal
+        /// operand or a repeated index of a permutation tensor.
+        template <class T>
+        static constexpr bool _structural_zero(std::integral auto... i)
+        {
+            if constexpr (diagonal_bind<T>) {
+                static constexpr auto x = _::is_bind<std::remove_cvref_t<T>>::index;
+                if constexpr (_outer.count(x[0]) == 0 or _outer.count(x[1]) == 0) {
+                    return false;
+                }
+                else {
+                    std::size_t const ind[] { std::size_t(i)... };
+                    return ind[_outer.index_of(x[0])] != ind[_outer.index_of(x[1])];
+                }
+            }
+            else if constexpr (levi_civita_bind<T> and _rank >= 2) {
+                static constexpr auto x = _::is_bind<std::remove_cvref_t<T>>::index;
+                std::size_t const ind[] { std::size_t(i)... };
+                for (std::size_t a = 0; a < x.size(); ++a) {
+                    for (std::size_t b = a + 1; b < x.size(); ++b) {
+                        if (_outer.count(x[a]) and _outer.count(x[b]) and ind[_outer.index_of(x[a])] == ind[_outer.index_of(x[b])]) {
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }
+            else {
+                return false;
+            }
+        }
+
+        /// Evaluate `t` at the inner index i..., mapped into its outer space.
+        template <std::size_t... m>
+        static constexpr auto _evaluate_at(auto const& t, std::index_sequence<m...>, std::integral auto... i)
+        {
+            std::size_t const ind[] { std::size_t(i)... };
+            return evaluate(t, ind[m]...);
+        }
+
+        /// Reduce `t` over the inner indices that follow the prefix i....
+        template <std::size_t... m>
+        constexpr auto _reduce_inner(auto const& t, std::index_sequence<m...> map, std::integral auto... i) const -> accumulator_type
+        {
+            static constexpr auto N = sizeof...(i);
+            if constexpr (N == _inner.size()) {
+                return _evaluate_at(t, map, i...);
+            }
+            else {
+                static constexpr auto index = index_map<_outer_ab, _inner>;
+                auto const inner = select_extents(index, _extents_ab());
+                accumulator_type accum = _identity();
+                for (std::size_t j = 0, e = inner.extent(N); j != e; ++j) {
+                    accum = reduce(accum, _reduce_inner(t, map, i..., j));
+                }
+                return accum;
+            }
+        }
+
+        /// Evaluate a product with a constant operand.
+        constexpr auto _constant_evaluate(std::integral auto... i) const -> scalar_type
+        {
+            if constexpr (constant_bind<B>) {
+                return op(_reduce_inner(_a, _map_a, i...), _b._a.value());
+            }
+            else {
+                return op(_a._a.value(), _reduce_inner(_b, _map_b, i...));
+            }
+        }
+
+        /// Evaluate a sparse gather by visiting only the nonzeros in the
+        /// slice selected by the sparse matrix's major index.
+        constexpr auto _sparse_evaluate(std::integral auto... i) const -> scalar_type
+        {
+            auto const& s = _sparse();
+            auto const offsets = s.offsets();
+            auto const indices = s.indices();
+            auto const values = s.values();
+
+            std::size_t const ind[] { std::size_t(i)... };
+            std::size_t const m = ind[_sparse_slot];
+
+            accumulator_type accum = _identity();
+            for (std::size_t k = offsets[m], e = offsets[m + 1]; k != e; ++k) {
+                accum = reduce(accum, _sparse_combine(values[k], i..., indices[k]));
+            }
+            return accum;
+        }
+
+        /// Evaluate a Voigt contraction directly from the reduced form.
+        constexpr auto _voigt_evaluate(std::integral auto... i) const -> scalar_type
+        {
+            static constexpr bool left = _voigt_contraction<A, B>;
+            using V = std::remove_cvref_t<std::conditional_t<left, A, B>>;
+            using E = std::remove_cvref_t<std::conditional_t<left, B, A>>;
+            using L = typename _::is_bind<V>::tensor_type::layout_type;
+
+            static constexpr auto x = _::is_bind<V>::index;
+            static constexpr auto y = _::is_bind<E>::index;
+            static constexpr std::size_t p = x.index_of(y[0]);
+            static constexpr std::size_t q = x.index_of(y[1]);
+            static constexpr std::size_t f = (p < 2) ? 2 : 0;
+
+            auto const& c = [&] -> auto const& {
+                if constexpr (left) {
+                    return _a._a;
+                }
+                else {
+                    return _b._a;
+                }
+            }();
+
+            auto const& e = [&] -> auto const& {
+                if constexpr (left) {
+                    return _b;
+                }
+                else {
+                    return _a;
+                }
+            }();
+
+            auto const combine = [&](auto const& u, auto const& v) {
+                if constexpr (left) {
+                    return op(u, v);
+                }
+                else {
+                    return op(v, u);
+                }
+            };
+
+            std::size_t const ind[] { std::size_t(i)... };
+            std::size_t idx[4];
+            idx[f] = ind[_outer.index_of(x[f])];
+            idx[f + 1] = ind[_outer.index_of(x[f + 1])];
+
+            auto const n = ttl::extent<0>(c);
+            accumulator_type accum = _identity();
+            for (std::size_t v = 0, m = L::size(n); v != m; ++v) {
+                auto const [k, l] = L::pair(n, v);
+                idx[p] = k;
+                idx[q] = l;
+                auto const cv = evaluate(c, idx[0], idx[1], idx[2], idx[3]);
+                accum = reduce(accum, combine(cv, evaluate(e, k, l)));
+                if (k != l) {
+                    accum = reduce(accum, combine(cv, evaluate(e, l, k)));
+                }
+            }
+            return accum;
+        }
+
         /// Map the indices from i... into the outer space for A and B, evaluate
         /// both subexpressions, and combine them using the configured `op`.
         template <std::size_t... a, std::size_t... b>
@@ -103,16 +714,46 @@ namespace ttl::tree
             auto const ab = _extents_ab();
             auto const inner = select_extents(map, ab);
 
+            // The index is fixed by a diagonal operand.
+            if constexpr (_diagonal_bound<N>.active) {
+                std::size_t const ind[] { std::size_t(i)... };
+                return _evaluate(i..., ind[_diagonal_bound<N>.p]);
+            }
+            // The index is determined by a permutation tensor.
+            else if constexpr (_levi_civita_bound<N>.active) {
+                static constexpr auto bound = _levi_civita_bound<N>;
+                std::size_t const ind[] { std::size_t(i)... };
+                if (bound.others == 2 and ind[bound.p[0]] == ind[bound.p[1]]) {
+                    return accumulator_type {};
+                }
+                std::size_t j = bound.others * (bound.others + 1) / 2;
+                for (std::size_t s = 0; s < bound.others; ++s) {
+                    j -= ind[bound.p[s]];
+                }
+                return _evaluate(i..., j);
+            }
+            // Skip the zero half of a triangular operand.
+            else if constexpr (_triangular_bound<N>.active) {
+                static constexpr auto bound = _triangular_bound<N>;
+                std::size_t const ind[] { std::size_t(i)... };
+                std::size_t const begin = bound.upper ? 0 : ind[bound.p];
+                std::size_t const end = bound.upper ? ind[bound.p] + 1 : inner.extent(N);
+                accumulator_type accum = _identity();
+                for (std::size_t j = begin; j != end; ++j) {
+                    accum = reduce(accum, _evaluate(i..., j));
+                }
+                return accum;
+            }
             // Accumulate the Nth extent. Help the compiler out here.
-            if constexpr (inner.static_extent(N) == std::dynamic_extent) {
-                accumulator_type accum {};
+            else if constexpr (inner.static_extent(N) == std::dynamic_extent) {
+                accumulator_type accum = _identity();
                 for (std::size_t j = 0, e = inner.extent(N); j != e; ++j) {
                     accum = reduce(accum, _evaluate(i..., j));
                 }
                 return accum;
             } else {
                 static constexpr std::size_t e = inner.static_extent(N);
-                accumulator_type accum {};
+                accumulator_type accum = _identity();
                 for (std::size_t j = 0; j != e; ++j) {
                     accum = reduce(accum, _evaluate(i..., j));
                 }
@@ -120,6 +761,163 @@ namespace ttl::tree
             }
         }
 
+        /// Evaluate the trace of a matrix product directly from the two leaves.
+        ///
+        /// When the operands are bound in the same order this is a simple
+        /// Frobenius-style dot product. When they are transposed, one of the
+        /// two is always traversed against its layout, so we traverse in tiles
+        /// in order to keep the strided side in cache.
+        constexpr auto _trace() const -> scalar_type
+        {
+            static constexpr auto x = _::is_bind<std::remove_cvref_t<A>>::index;
+            static constexpr auto y = _::is_bind<std::remove_cvref_t<B>>::index;
+
+            auto const& a = _a._a;
+            auto const& b = _b._a;
+            auto const m = ttl::extent<0>(a);
+            auto const n = ttl::extent<1>(a);
+
+            if constexpr (_multiplicative and (diagonal_bind<A> or diagonal_bind<B>)) {
+                // Only the diagonal terms can be nonzero.
+                accumulator_type accum = _identity();
+                for (std::size_t i = 0; i != m; ++i) {
+                    accum = reduce(accum, op(evaluate(a, i, i), evaluate(b, i, i)));
+                }
+                return accum;
+            }
+            else if constexpr (symmetric_bind<A> and symmetric_bind<B>) {
+                // Both operands are symmetric, so the order doesn't matter and
+                // each off-diagonal element in the stored triangle accounts
+                // for two terms.
+                accumulator_type accum = _identity();
+                for (std::size_t i = 0; i != m; ++i) {
+                    for (std::size_t j = 0; j != i; ++j) {
+                        auto const v = op(evaluate(a, i, j), evaluate(b, i, j));
+                        accum = reduce(reduce(accum, v), v);
+                    }
+                    accum = reduce(accum, op(evaluate(a, i, i), evaluate(b, i, i)));
+                }
+                return accum;
+            }
+            else if constexpr (x == y) {
+                accumulator_type accum = _identity();
+                for (std::size_t i = 0; i != m; ++i) {
+                    for (std::size_t j = 0; j != n; ++j) {
+                        accum = reduce(accum, op(evaluate(a, i, j), evaluate(b, i, j)));
+                    }
+                }
+                return accum;
+            }
+            else {
+                return _blocked_trace(
+                    [&](std::size_t i, std::size_t j) { return evaluate(a, i, j); },
+                    [&](std::size_t j, std::size_t i) { return evaluate(b, j, i); },
+                    m, n);
+            }
+        }
+
+        /// Evaluate the trace of a chain of three matrices.
+        ///
+        /// We rename the three indices so that the chain reads
+        /// A(a,b) * B(b,c) * C(c,a), and then pick the rotation of the cycle
+        /// that contracts the largest extent first. Only that pairwise product
+        /// is materialized, and the final contraction with the remaining
+        /// operand is a blocked transposed trace.
+        constexpr auto _trace_chain() const -> scalar_type
+        {
+            static constexpr auto xa = _::is_bind<std::remove_cvref_t<decltype(_a._a)>>::index;
+            static constexpr auto xb = _::is_bind<std::remove_cvref_t<decltype(_a._b)>>::index;
+            static constexpr auto xc = _::is_bind<std::remove_cvref_t<B>>::index;
+
+            static constexpr char b = (xa + xb).contracted()[0];
+            static constexpr char a = (xa[0] == b) ? xa[1] : xa[0];
+            static constexpr char c = (xb[0] == b) ? xb[1] : xb[0];
+
+            auto const& ta = _a._a._a;
+            auto const& tb = _a._b._a;
+            auto const& tc = _b._a;
+
+            auto const fa = [&](std::size_t va, std::size_t vb) {
+                if constexpr (xa[0] == a) {
+                    return evaluate(ta, va, vb);
+                }
+                else {
+                    return evaluate(ta, vb, va);
+                }
+            };
+
+            auto const fb = [&](std::size_t vb, std::size_t vc) {
+                if constexpr (xb[0] == b) {
+                    return evaluate(tb, vb, vc);
+                }
+                else {
+                    return evaluate(tb, vc, vb);
+                }
+            };
+
+            auto const fc = [&](std::size_t vc, std::size_t va) {
+                if constexpr (xc[0] == c) {
+                    return evaluate(tc, vc, va);
+                }
+                else {
+                    return evaluate(tc, va, vc);
+                }
+            };
+
+            auto const na = ttl::extent(ta, xa.index_of(a));
+            auto const nb = ttl::extent(ta, xa.index_of(b));
+            auto const nc = ttl::extent(tb, xb.index_of(c));
+
+            if (na <= nb and nc <= nb) {
+                return _cyclic_trace(fa, fb, fc, na, nb, nc);
+            }
+            else if (na <= nc) {
+                return _cyclic_trace(fb, fc, fa, nb, nc, na);
+            }
+            else {
+                return _cyclic_trace(fc, fa, fb, nc, na, nb);
+            }
+        }
+
+        /// Compute `f(p,q) * g(q,r) * h(r,p)`, contracting `q` into an
+        /// intermediate `t(p,r)` first.
+        static constexpr auto _cyclic_trace(auto const& f, auto const& g, auto const& h, std::size_t np, std::size_t nq, std::size_t nr) -> accumulator_type
+        {
+            std::vector<accumulator_type> t(np * nr, _identity());
+            for (std::size_t p = 0; p != np; ++p) {
+                for (std::size_t q = 0; q != nq; ++q) {
+                    auto const fpq = f(p, q);
+                    for (std::size_t r = 0; r != nr; ++r) {
+                        t[p * nr + r] = reduce(t[p * nr + r], op(fpq, g(q, r)));
+                    }
+                }
+            }
+
+            return _blocked_trace(
+                [&](std::size_t p, std::size_t r) { return t[p * nr + r]; },
+                h, np, nr);
+        }
+
+        /// Compute `f(i,j) * h(j,i)` by traversing (i,j) in square tiles.
+        static constexpr auto _blocked_trace(auto const& f, auto const& h, std::size_t m, std::size_t n) -> accumulator_type
+        {
+            static constexpr std::size_t tile = 32;
+
+            accumulator_type accum = _identity();
+            for (std::size_t i0 = 0; i0 < m; i0 += tile) {
+                auto const i1 = std::min(i0 + tile, m);
+                for (std::size_t j0 = 0; j0 < n; j0 += tile) {
+                    auto const j1 = std::min(j0 + tile, n);
+                    for (std::size_t i = i0; i != i1; ++i) {
+                        for (std::size_t j = j0; j != j1; ++j) {
+                            accum = reduce(accum, op(f(i, j), h(j, i)));
+                        }
+                    }
+                }
+            }
+            return accum;
+        }
+
         /// Create the concatenated extents of the two subexpressions.
         constexpr auto _extents_ab() const
         {
@@ -129,14 +927,99 @@ namespace ttl::tree
         }
     };
 
+    /// A product that might be symmetric (see `product::_symmetric_pattern`).
+    template <class T>
+    concept symmetric_product = requires {
+        requires std::remove_cvref_t<T>::_symmetric_pattern;
+    };
+
+    /// A sparse-dense product (see `product::_sparse_gather` and
+    /// `product::_sparse_scatter`).
+    template <class T>
+    concept sparse_product = requires {
+        requires std::remove_cvref_t<T>::_sparse_gather or std::remove_cvref_t<T>::_sparse_scatter;
+    };
+
+    /// A product with no contracted indices.
+    template <class T>
+    concept outer_product = requires {
+        requires std::remove_cvref_t<T>::_outer_pattern;
+    };
+
     template <expression A, expression B>
     struct mul : product<A, B, std::multiplies {}, std::plus {}> {
         using mul::product::product;
     };
 
     template <expression A, expression B>
+        requires _::shifted_indices_free<outer<A> + outer<B>, A, B>
     constexpr auto operator*(A&& a, B&& b) -> mul<A, B>
     {
         return mul<A, B>(__fwd(a), __fwd(b));
     }
+
+    /// The tropical (shortest path) product, min over the contracted indices
+    /// of a + b.
+    template <expression A, expression B>
+    struct min_plus : product<A, B, std::plus {}, minimum {}> {
+        using min_plus::product::product;
+    };
+
+    /// The max-plus (longest path) product.
+    template <expression A, expression B>
+    struct max_plus : product<A, B, std::plus {}, maximum {}> {
+        using max_plus::product::product;
+    };
+
+    /// The max-times (Viterbi) product.
+    template <expression A, expression B>
+    struct max_times : product<A, B, std::multiplies {}, maximum {}> {
+        using max_times::product::product;
+    };
+
+    /// The boolean (reachability) product, or over the contracted indices of
+    /// a and b.
+    template <expression A, expression B>
+    struct or_and : product<A, B, std::logical_and {}, std::logical_or {}> {
+        using or_and::product::product;
+    };
+
+    /// A product of two matrices over a semiring other than (+, *), e.g.,
+    /// min_plus(A(i,k), B(k,j)).
+    template <class T>
+    concept semiring_matrix_product = requires {
+        requires std::remove_cvref_t<T>::_matrix_pattern;
+        requires not std::remove_cvref_t<T>::_multiplicative;
+    };
+}
+
+namespace ttl
+{
+    /// Products over semirings, written in index notation, e.g.,
+    /// D(i,j) = ttl::min_plus(A(i,k), B(k,j)).
+    /// @{
+    template <expression A, expression B>
+    inline constexpr auto min_plus(A&& a, B&& b) -> tree::min_plus<A, B>
+    {
+        return tree::min_plus<A, B>(__fwd(a), __fwd(b));
+    }
+
+    template <expression A, expression B>
+    inline constexpr auto max_plus(A&& a, B&& b) -> tree::max_plus<A, B>
+    {
+        return tree::max_plus<A, B>(__fwd(a), __fwd(b));
+    }
+
+    template <expression A, expression B>
+    inline constexpr auto max_times(A&& a, B&& b) -> tree::max_times<A, B>
+    {
+        return tree::max_times<A, B>(__fwd(a), __fwd(b));
+    }
+
+    template <expression A, expression B>
+    inline constexpr auto or_and(A&& a, B&& b) -> tree::or_and<A, B>
+    {
+        return tree::or_and<A, B>(__fwd(a), __fwd(b));
+    }
+    /// @}
 }
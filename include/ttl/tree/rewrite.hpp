@@ -0,0 +1,1213 @@
+#pragma once
+
+#include <ttl/evaluate.hpp>
+#include <ttl/extents.hpp>
+#include <ttl/index.hpp>
+#include <ttl/index_string.hpp>
+#include <ttl/outer.hpp>
+#include <ttl/tensor.hpp>
+#include <ttl/tree/bind.hpp>
+#include <ttl/tree/negate.hpp>
+#include <ttl/tree/node.hpp>
+#include <ttl/tree/product.hpp>
+#include <ttl/tree/scan.hpp>
+#include <ttl/tree/sum.hpp>
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace ttl::tree
+{
+    /// A node that evaluates the rewritten expression A if the condition of
+    /// the rewrite held, and the original expression B otherwise.
+    ///
+    /// Some rewrites are only valid if two operands read the same tensors,
+    /// e.g., A(i,j) * x(j) + A(i,j) * y(j) is A(i,j) * (x(j) + y(j)), which is
+    /// only known at runtime (see `_::simplify`). Assignments choose between
+    /// the two once when the alternative is the root of the expression.
+    template <expression A, expression B>
+    struct alternative : node {
+        using scalar_type = std::remove_cvref_t<ttl::scalar_type<B>>;
+
+        static constexpr auto _outer = ttl::outer<B>;
+        static_assert(is_permutation(ttl::outer<A>, _outer));
+
+        static constexpr auto _map_a = index_map<_outer, ttl::outer<A>>;
+
+        /// This node type with other children, e.g., for rewriting.
+        template <class X, class Y>
+        using _rebuild = alternative<X, Y>;
+
+        A _a;
+        B _b;
+        bool _rewritten;
+
+        constexpr alternative(A a, B b, bool rewritten)
+            : _a(__fwd(a))
+            , _b(__fwd(b))
+            , _rewritten(rewritten)
+        {
+        }
+
+        static constexpr auto outer()
+        {
+            return _outer;
+        }
+
+        constexpr auto extents() const
+        {
+            return ttl::extents(_b);
+        }
+
+        constexpr auto operator[](std::integral auto... i) const -> scalar_type
+        {
+            static_assert(sizeof...(i) == _outer.rank());
+            assert(_check_bounds(i...));
+            if (_rewritten) {
+                return _evaluate(_a, _map_a, i...);
+            }
+            return ttl::evaluate(_b, i...);
+        }
+
+    private:
+        template <std::size_t... m>
+        static constexpr auto _evaluate(auto const& x, std::index_sequence<m...>, std::integral auto... i) -> scalar_type
+        {
+            if constexpr (sizeof...(i) != 0) {
+                std::common_type_t<decltype(i)...> const is[] { i... };
+                return ttl::evaluate(x, is[m]...);
+            }
+            else {
+                return ttl::evaluate(x);
+            }
+        }
+    };
+}
+
+/// Tools for inspecting and rebuilding expression trees.
+///
+/// Nodes are addressed by their `path` from the root, and rebuilt with other
+/// children through their `_rebuild` member templates. The algebraic
+/// simplification and common subexpression elimination that assignments
+/// perform (see `execution_traits::assign`) are built on top of these.
+namespace ttl::tree::_
+{
+    /// Check to see if every element of `T` can be evaluated independently, at
+    /// any point.
+    ///
+    /// Scans and shifted views can't, since assignments evaluate them with
+    /// their own kernels (see `execution_traits::_assign_scan` and
+    /// `execution_traits::_assign_stencil`).
+    template <class T>
+    inline constexpr bool pointwise = [] {
+        using U = std::remove_cvref_t<T>;
+        if constexpr (requires { U::_scan_slot; }) {
+            return false;
+        }
+        else if constexpr (tree::is_bind<U>) {
+            using X = typename tree::_::is_bind<U>::tensor_type;
+            if constexpr (requires { requires X::is_shifted; }) {
+                return false;
+            }
+            else if constexpr (std::derived_from<X, node>) {
+                return pointwise<X>;
+            }
+            else {
+                return true;
+            }
+        }
+        else if constexpr (requires(U const& u) { u._a; u._b; }) {
+            return pointwise<decltype(std::declval<U const&>()._a)> and pointwise<decltype(std::declval<U const&>()._b)>;
+        }
+        else if constexpr (requires(U const& u) { u._a; }) {
+            return pointwise<decltype(std::declval<U const&>()._a)>;
+        }
+        else {
+            return true;
+        }
+    }();
+
+    /// Check to see if `T` is a leaf of an expression, i.e., a bound tensor or
+    /// a scalar.
+    template <class T>
+    inline constexpr bool is_leaf = [] {
+        using U = std::remove_cvref_t<T>;
+        if constexpr (tree::is_bind<U>) {
+            return not std::derived_from<typename tree::_::is_bind<U>::tensor_type, node>;
+        }
+        else {
+            return not std::derived_from<U, node>;
+        }
+    }();
+
+    template <class T>
+    concept binary = requires(std::remove_cvref_t<T> const& t) { t._a; t._b; };
+
+    /// The declared types of the children of a node.
+    template <class T>
+    using child_a = decltype(std::remove_cvref_t<T>::_a);
+
+    template <class T>
+    using child_b = decltype(std::remove_cvref_t<T>::_b);
+
+    /// The type of the node `T` with the children `X...`.
+    template <class T, class... X>
+    using rebuild = typename std::remove_cvref_t<T>::template _rebuild<X...>;
+
+    /// The position of a node in an expression, i.e., the sequence of children
+    /// (`_a` or `_b`) that leads to it from the root.
+    struct path {
+        std::uint64_t bits = 0;
+        std::size_t depth = 0;
+
+        constexpr bool operator==(path const&) const = default;
+
+        /// Check to see if the step at depth `d` is to `_b`.
+        constexpr bool operator[](std::size_t d) const
+        {
+            return (bits >> d) & 1;
+        }
+
+        constexpr auto a() const -> path
+        {
+            return { bits, depth + 1 };
+        }
+
+        constexpr auto b() const -> path
+        {
+            return { bits | (std::uint64_t(1) << depth), depth + 1 };
+        }
+
+        /// Check to see if `q` is this node or one of its descendants.
+        constexpr bool contains(path const& q) const
+        {
+            return depth <= q.depth and (q.bits & ((std::uint64_t(1) << depth) - 1)) == bits;
+        }
+    };
+
+    /// The subtree of `t` at `p`.
+    template <path p, std::size_t d = 0>
+    inline constexpr auto at(auto const& t) -> auto const&
+    {
+        if constexpr (d == p.depth) {
+            return t;
+        }
+        else if constexpr (p[d]) {
+            return at<p, d + 1>(t._b);
+        }
+        else {
+            return at<p, d + 1>(t._a);
+        }
+    }
+
+    template <class T, path p>
+    using subtree = std::remove_cvref_t<decltype(at<p>(std::declval<T const&>()))>;
+
+    /// The number of nodes (i.e., non-leaves) in `T`.
+    template <class T>
+    inline constexpr std::size_t node_count = [] {
+        if constexpr (is_leaf<T>) {
+            return 0zu;
+        }
+        else if constexpr (binary<T>) {
+            return 1 + node_count<child_a<T>> + node_count<child_b<T>>;
+        }
+        else {
+            return 1 + node_count<child_a<T>>;
+        }
+    }();
+
+    template <class T>
+    inline constexpr void collect_paths(path p, path*& out)
+    {
+        if constexpr (not is_leaf<T>) {
+            *out++ = p;
+            collect_paths<child_a<T>>(p.a(), out);
+            if constexpr (binary<T>) {
+                collect_paths<child_b<T>>(p.b(), out);
+            }
+        }
+    }
+
+    /// The paths of the nodes in `T`, in pre-order.
+    template <class T>
+    inline constexpr auto paths = [] {
+        std::array<path, node_count<T>> out {};
+        path* p = out.data();
+        collect_paths<T>({}, p);
+        return out;
+    }();
+
+    /// A renaming of index characters.
+    using renaming = std::array<char, 128>;
+
+    /// Add the index characters of `T` to `map`, in order of their first
+    /// appearance.
+    template <class T>
+    inline constexpr void collect_indices(renaming& map, char& next)
+    {
+        using U = std::remove_cvref_t<T>;
+        auto const add = [&](char c) {
+            if (c != projected_index and map[c] == 0) {
+                map[c] = next++;
+            }
+        };
+        if constexpr (tree::is_bind<U>) {
+            constexpr auto index = tree::_::is_bind<U>::index;
+            for (std::size_t n = 0; n < index.size(); ++n) {
+                add(index[n]);
+            }
+        }
+        if constexpr (requires { U::_scan_slot; }) {
+            add(U::_outer[U::_scan_slot]);
+        }
+        if constexpr (not is_leaf<U>) {
+            collect_indices<child_a<U>>(map, next);
+            if constexpr (binary<U>) {
+                collect_indices<child_b<U>>(map, next);
+            }
+        }
+    }
+
+    /// Rename the indices of `T` using `map`.
+    ///
+    /// The children are stored by value in the result, which is only used to
+    /// compare the structure of expressions.
+    template <class T, renaming map>
+    struct rename {
+        using type = std::remove_cvref_t<T>;
+    };
+
+    template <class T, renaming map>
+    using rename_t = typename rename<std::remove_cvref_t<T>, map>::type;
+
+    template <class A, index_string str, renaming map>
+    struct rename<bind<A, str>, map> {
+        static constexpr auto index = [] {
+            auto out = str;
+            for (std::size_t n = 0; n < str.size(); ++n) {
+                if (str[n] != projected_index) {
+                    out._data[n] = map[str[n]];
+                }
+            }
+            return out;
+        }();
+
+        using type = bind<rename_t<A, map>, index>;
+    };
+
+    template <class A, char c, auto op, bool exclusive, renaming map>
+    struct rename<scan<A, c, op, exclusive>, map> {
+        using type = scan<rename_t<A, map>, map[c], op, exclusive>;
+    };
+
+    template <class T, renaming map>
+        requires(std::derived_from<T, node> and not binary<T> and not tree::is_bind<T> and not requires { T::_scan_slot; })
+    struct rename<T, map> {
+        using type = rebuild<T, rename_t<child_a<T>, map>>;
+    };
+
+    template <class T, renaming map>
+        requires(std::derived_from<T, node> and binary<T>)
+    struct rename<T, map> {
+        using type = rebuild<T, rename_t<child_a<T>, map>, rename_t<child_b<T>, map>>;
+    };
+
+    /// The structure of `T`, with its indices renamed in order of their first
+    /// appearance.
+    ///
+    /// Two subtrees with the same canonical type compute the same function of
+    /// their leaves, e.g., x(i) + y(i) and x(j) + y(j), and since the outer
+    /// indices are renamed consistently the k-th outer index of one
+    /// corresponds to the k-th outer index of the other.
+    template <class T>
+    inline constexpr renaming canonical_indices = [] {
+        renaming map {};
+        char next = 'a';
+        collect_indices<T>(map, next);
+        return map;
+    }();
+
+    template <class T>
+    using canonical = rename_t<T, canonical_indices<T>>;
+
+    /// The number of indices that are looped over when evaluating the subtree
+    /// of `T` at `p`, given that `T` itself is evaluated over `n` indices.
+    ///
+    /// Contractions (in products and binds) loop over their contracted
+    /// indices for every element, and scans loop over their scanned index.
+    template <class T, path p, std::size_t d = 0>
+    inline constexpr auto loops(std::size_t n = ttl::rank<T>) -> std::size_t
+    {
+        using U = std::remove_cvref_t<T>;
+        if constexpr (d == p.depth) {
+            return n;
+        }
+        else {
+            if constexpr (requires { U::_inner; U::_outer; }) {
+                n += U::_inner.size() - U::_outer.size();
+            }
+            if constexpr (requires { U::_scan_slot; }) {
+                n += 1;
+            }
+            if constexpr (p[d]) {
+                return loops<child_b<U>, p, d + 1>(n);
+            }
+            else {
+                return loops<child_a<U>, p, d + 1>(n);
+            }
+        }
+    }
+
+    /// Check to see if evaluating an element of `T` costs more than reading
+    /// it, i.e., if it contains a contraction, a function or a scan.
+    template <class T>
+    inline constexpr bool costly = [] {
+        using U = std::remove_cvref_t<T>;
+        if constexpr (is_leaf<U>) {
+            return false;
+        }
+        else if constexpr (requires { requires U::_inner.size() != U::_outer.size(); }) {
+            return true;
+        }
+        else if constexpr (requires { U::_op; } and not binary<U>) {
+            return true;
+        }
+        else if constexpr (binary<U>) {
+            return costly<child_a<U>> or costly<child_b<U>>;
+        }
+        else {
+            return costly<child_a<U>>;
+        }
+    }();
+
+    /// The first node of `T` that has the same canonical type as its n-th
+    /// node.
+    template <class T, std::size_t n>
+    inline constexpr std::size_t first_equivalent = []<std::size_t... m>(std::index_sequence<m...>) {
+        using S = canonical<subtree<T, paths<T>[n]>>;
+        std::size_t out = n;
+        ((out = (m < out and std::same_as<canonical<subtree<T, paths<T>[m]>>, S>) ? m : out), ...);
+        return out;
+    }(std::make_index_sequence<n>());
+
+    /// Find the subtrees of `T` that repeat the first common subexpression
+    /// worth evaluating once.
+    ///
+    /// Subexpressions are candidates when they can be evaluated a point at a
+    /// time and either cost more than a read (see `costly`) or are evaluated
+    /// at more points than they have elements, e.g., the rank-1 sums in
+    /// (x(i) + y(i)) * (x(j) + y(j)). Larger subtrees come first, so nested
+    /// repeats are found once the enclosing ones have been replaced.
+    template <class T>
+    inline constexpr auto common_occurrences = []<std::size_t... n>(std::index_sequence<n...>) {
+        constexpr auto ps = paths<T>;
+        constexpr std::size_t N = sizeof...(n);
+        std::size_t const first[] { first_equivalent<T, n>..., N };
+        bool const candidate[] { pointwise<subtree<T, ps[n]>>..., false };
+        bool const worth[] { (costly<subtree<T, ps[n]>> or loops<T, ps[n]>() > ttl::rank<subtree<T, ps[n]>>)..., false };
+
+        struct {
+            std::size_t size = 0;
+            std::array<path, N> paths {};
+        } out;
+
+        for (std::size_t r = 0; r < N and out.size == 0; ++r) {
+            if (first[r] != r or not candidate[r]) {
+                continue;
+            }
+            std::size_t count = 0;
+            bool any = false;
+            for (std::size_t m = r; m < N; ++m) {
+                if (first[m] == r) {
+                    count += 1;
+                    any = any or worth[m];
+                }
+            }
+            if (count < 2 or not any) {
+                continue;
+            }
+            for (std::size_t m = r; m < N; ++m) {
+                if (first[m] == r) {
+                    out.paths[out.size++] = ps[m];
+                }
+            }
+        }
+        return out;
+    }(std::make_index_sequence<node_count<T>>());
+
+    /// The paths of the common subexpressions that assignments materialize,
+    /// starting with the one that is evaluated.
+    template <class T>
+    inline constexpr auto common_paths = [] {
+        constexpr auto occurrences = common_occurrences<std::remove_cvref_t<T>>;
+        std::array<path, occurrences.size> out;
+        std::ranges::copy_n(occurrences.paths.begin(), occurrences.size, out.begin());
+        return out;
+    }();
+
+    /// Check to see if `T` is a prefix scan (see `tree::scan`).
+    template <class T>
+    inline constexpr bool is_scan = requires { std::remove_cvref_t<T>::_scan_slot; };
+
+    /// The paths of the scans in `T`, in pre-order, so the last one doesn't
+    /// contain another scan.
+    template <class T>
+    inline constexpr auto scan_paths = []<std::size_t... n>(std::index_sequence<n...>) {
+        using U = std::remove_cvref_t<T>;
+        constexpr auto ps = paths<U>;
+        std::array<path, (0zu + ... + std::size_t(is_scan<subtree<U, ps[n]>>))> out {};
+        std::size_t m = 0;
+        ((is_scan<subtree<U, ps[n]>> ? void(out[m++] = ps[n]) : void()), ...);
+        return out;
+    }(std::make_index_sequence<node_count<std::remove_cvref_t<T>>>());
+
+    /// Check to see if two subtrees with the same canonical type read the same
+    /// leaves, i.e., the same tensors with the same projections, and equal
+    /// scalars.
+    inline constexpr bool same_leaves(auto const& x, auto const& y)
+    {
+        using X = std::remove_cvref_t<decltype(x)>;
+        if constexpr (tree::is_bind<X>) {
+            constexpr auto index = tree::_::is_bind<X>::index;
+            for (std::size_t n = 0; n < index.size(); ++n) {
+                if (index[n] == projected_index and x._id[n] != y._id[n]) {
+                    return false;
+                }
+            }
+            if constexpr (is_leaf<X>) {
+                return same_tensor(x._a, y._a);
+            }
+            else {
+                return same_leaves(x._a, y._a);
+            }
+        }
+        else if constexpr (is_leaf<X>) {
+            return x == y;
+        }
+        else if constexpr (requires { x._rewritten; }) {
+            return x._rewritten == y._rewritten and same_leaves(x._a, y._a) and same_leaves(x._b, y._b);
+        }
+        else if constexpr (binary<X>) {
+            return same_leaves(x._a, y._a) and same_leaves(x._b, y._b);
+        }
+        else {
+            return same_leaves(x._a, y._a);
+        }
+    }
+
+    /// Check to see if the occurrences of the common subexpression of `t` (see
+    /// `common_paths`) actually read the same leaves.
+    template <class T>
+    inline constexpr bool common_leaves(T const& t)
+    {
+        static constexpr auto qs = common_paths<T>;
+        return [&]<std::size_t... n>(std::index_sequence<n...>) {
+            return (same_leaves(at<qs[0]>(t), at<qs[n]>(t)) and ...);
+        }(std::make_index_sequence<qs.size()>());
+    }
+
+    /// Check to see if `p` contains any of the paths in `qs`.
+    template <auto qs, path p>
+    inline constexpr bool touches = std::ranges::any_of(qs, [](path const& q) {
+        return p.contains(q);
+    });
+
+    template <auto qs, path p>
+    inline constexpr auto substitute(auto const& t, auto const& f);
+
+    /// The child of a node that is being substituted. Children that aren't
+    /// touched are forwarded as they are, so that their declared types can be
+    /// kept.
+    template <auto qs, path p>
+    inline constexpr auto substitute_child(auto&& a, auto const& f) -> decltype(auto)
+    {
+        if constexpr (touches<qs, p>) {
+            return substitute<qs, p>(a, f);
+        }
+        else {
+            return __fwd(a);
+        }
+    }
+
+    template <class A, auto qs, path p, class F, bool = touches<qs, p>>
+    struct substitute_type {
+        using type = A;
+    };
+
+    template <class A, auto qs, path p, class F>
+    struct substitute_type<A, qs, p, F, true> {
+        using type = decltype(substitute<qs, p>(std::declval<A const&>(), std::declval<F const&>()));
+    };
+
+    /// The type of a child after substitution, which is its declared type if
+    /// it isn't touched.
+    template <class A, auto qs, path p, class F>
+    using substitute_t = typename substitute_type<A, qs, p, F>::type;
+
+    /// Rebuild the expression `t` (at `p`) with each of its subtrees at the
+    /// paths in `qs` replaced by `f.template operator()<q>(subtree)`.
+    template <auto qs, path p = path {}>
+    inline constexpr auto substitute(auto const& t, auto const& f)
+    {
+        using U = std::remove_cvref_t<decltype(t)>;
+        using F = std::remove_cvref_t<decltype(f)>;
+        if constexpr (std::ranges::find(qs, p) != qs.end()) {
+            return f.template operator()<p>(t);
+        }
+        else if constexpr (tree::is_bind<U>) {
+            using X = substitute_t<child_a<U>, qs, p.a(), F>;
+            return bind<X, tree::_::is_bind<U>::index>(substitute_child<qs, p.a()>(t._a, f), t._id);
+        }
+        else if constexpr (requires { t._rewritten; }) {
+            using X = substitute_t<child_a<U>, qs, p.a(), F>;
+            using Y = substitute_t<child_b<U>, qs, p.b(), F>;
+            return alternative<X, Y>(substitute_child<qs, p.a()>(t._a, f), substitute_child<qs, p.b()>(t._b, f), t._rewritten);
+        }
+        else if constexpr (binary<U>) {
+            using X = substitute_t<child_a<U>, qs, p.a(), F>;
+            using Y = substitute_t<child_b<U>, qs, p.b(), F>;
+            return rebuild<U, X, Y>(substitute_child<qs, p.a()>(t._a, f), substitute_child<qs, p.b()>(t._b, f));
+        }
+        else {
+            using X = substitute_t<child_a<U>, qs, p.a(), F>;
+            return rebuild<U, X>(substitute_child<qs, p.a()>(t._a, f));
+        }
+    }
+
+    /// Check to see if `T` is a scalar constant, e.g., the 2 in 2 * A(i,j).
+    template <class T>
+    concept arithmetic = std::is_arithmetic_v<std::remove_cvref_t<T>>;
+
+    template <class T>
+    concept multiplicative = requires { requires std::remove_cvref_t<T>::_multiplicative; };
+
+    /// A product of a scalar constant and a tensor, e.g., 2 * A(i,j) or
+    /// A(i,j) * 2.
+    template <class T>
+    concept scaled = multiplicative<T> and (arithmetic<child_a<T>> != arithmetic<child_b<T>>);
+
+    /// A product that contracts some of its indices.
+    template <class T>
+    concept contraction = multiplicative<T> and requires { requires std::remove_cvref_t<T>::_inner.size() != std::remove_cvref_t<T>::_outer.size(); };
+
+    template <class T>
+    concept negation = requires(std::remove_cvref_t<T> const* t) {
+        []<class X>(unary_prefix<X, std::negate {}> const*) {}(t);
+    };
+
+    /// An element-wise sum node with the operation `Op`, e.g., std::plus<>.
+    template <class T, class Op>
+    concept sum_with = binary<T> and not requires { std::remove_cvref_t<T>::_reduce; } and requires {
+        requires std::same_as<std::remove_cvref_t<decltype(std::remove_cvref_t<T>::_op)>, Op>;
+    };
+
+    template <class T>
+    concept alternative_node = requires(std::remove_cvref_t<T> const& t) { t._rewritten; };
+
+    /// A bound Kronecker delta with two distinct free indices, e.g., delta(i,j).
+    template <class T>
+    concept delta_bind = is_leaf<T> and tree::is_bind<std::remove_cvref_t<T>> and requires {
+        requires tree::_::is_bind<std::remove_cvref_t<T>>::tensor_type::is_identity;
+        requires tree::_::is_bind<std::remove_cvref_t<T>>::index.outer().size() == 2;
+    };
+
+    /// Check to see if every element of `T` is zero, i.e., if it's a bound
+    /// zero tensor (see `ttl::zeros`) or built from them.
+    template <class T>
+    inline constexpr bool zero = [] {
+        using U = std::remove_cvref_t<T>;
+        if constexpr (tree::is_bind<U>) {
+            using X = typename tree::_::is_bind<U>::tensor_type;
+            if constexpr (requires { requires X::is_zero; }) {
+                return true;
+            }
+            else if constexpr (std::derived_from<X, node>) {
+                return zero<X>;
+            }
+            else {
+                return false;
+            }
+        }
+        else if constexpr (negation<U>) {
+            return zero<child_a<U>>;
+        }
+        else if constexpr (multiplicative<U> or sum_with<U, std::multiplies<>>) {
+            return zero<child_a<U>> or zero<child_b<U>>;
+        }
+        else if constexpr (sum_with<U, std::plus<>> or sum_with<U, std::minus<>>) {
+            return zero<child_a<U>> and zero<child_b<U>>;
+        }
+        else {
+            return false;
+        }
+    }();
+
+    /// The scalar constant of a scaled product.
+    inline constexpr auto scale(scaled auto const& t)
+    {
+        if constexpr (arithmetic<decltype(t._a)>) {
+            return std::remove_cvref_t<decltype(t._a)>(t._a);
+        }
+        else {
+            return std::remove_cvref_t<decltype(t._b)>(t._b);
+        }
+    }
+
+    /// The tensor operand of a scaled product.
+    inline constexpr auto base(scaled auto const& t)
+    {
+        if constexpr (arithmetic<decltype(t._a)>) {
+            return std::remove_cvref_t<decltype(t._b)>(t._b);
+        }
+        else {
+            return std::remove_cvref_t<decltype(t._a)>(t._a);
+        }
+    }
+
+    template <class X, class Y>
+    inline constexpr auto multiply(X x, Y y) -> product<X, Y, std::multiplies {}, std::plus {}>
+    {
+        return { std::move(x), std::move(y) };
+    }
+
+    /// Fold the scalar constants `c` and `d` with `op` in the scalar type `S`
+    /// of the tree they come from, rather than in their own types, e.g.,
+    /// -1 * (2u * A(i)) is -2.0 * A(i) if A holds doubles, not 4294967294u *
+    /// A(i).
+    ///
+    /// Signed integers can overflow where the tree wouldn't, e.g., when the
+    /// tensor is zero, so the result is paired with whether it's exact.
+    template <class S, auto op>
+    inline constexpr auto fold(auto c, auto d) -> std::pair<S, bool>
+    {
+        if constexpr (std::signed_integral<S>) {
+            using Op = std::remove_cvref_t<decltype(op)>;
+            S r {};
+            bool overflow = false;
+            if constexpr (std::same_as<Op, std::plus<>>) {
+                overflow = __builtin_add_overflow(S(c), S(d), &r);
+            }
+            else if constexpr (std::same_as<Op, std::minus<>>) {
+                overflow = __builtin_sub_overflow(S(c), S(d), &r);
+            }
+            else {
+                static_assert(std::same_as<Op, std::multiplies<>>);
+                overflow = __builtin_mul_overflow(S(c), S(d), &r);
+            }
+            return { r, not overflow };
+        }
+        else {
+            return { S(op(S(c), S(d))), true };
+        }
+    }
+
+    /// The product of the folded constant `c` and `x`, which rewrites `t`, or
+    /// an alternative that evaluates `t` if `c` isn't exact.
+    template <class T, class S>
+    inline constexpr auto multiply_folded(T const& t, std::pair<S, bool> c, auto const& x)
+    {
+        if constexpr (std::signed_integral<S>) {
+            return alternative(multiply(c.first, std::remove_cvref_t<decltype(x)>(x)), t, c.second);
+        }
+        else {
+            return multiply(c.first, std::remove_cvref_t<decltype(x)>(x));
+        }
+    }
+
+    template <auto op, class X, class Y>
+    inline constexpr auto combine(X x, Y y) -> sum<X, Y, op>
+    {
+        return { std::move(x), std::move(y) };
+    }
+
+    inline constexpr renaming identity_renaming = [] {
+        renaming map {};
+        for (std::size_t c = 0; c < map.size(); ++c) {
+            map[c] = char(c);
+        }
+        return map;
+    }();
+
+    /// The structure of `T`, i.e., `T` with every child stored by value.
+    template <class T>
+    using structure = rename_t<T, identity_renaming>;
+
+    /// Check to see if contracting `x` with the delta `d` renames one of the
+    /// free indices of `x`, e.g., delta(i,j) * A(j,k) is A(i,k).
+    ///
+    /// Exactly one of the delta's indices has to be contracted, and the other
+    /// one can't already appear in `x`.
+    template <class D, class X, class P>
+    inline constexpr bool renames_delta = [] {
+        if constexpr (not delta_bind<D> or arithmetic<X>) {
+            return false;
+        }
+        else {
+            constexpr auto d = tree::_::is_bind<std::remove_cvref_t<D>>::index;
+            constexpr auto x = [] {
+                if constexpr (is_leaf<X>) {
+                    return tree::_::is_bind<std::remove_cvref_t<X>>::index;
+                }
+                else {
+                    return ttl::outer<X>;
+                }
+            }();
+            constexpr auto outer = ttl::outer<X>;
+            using S = std::remove_cvref_t<ttl::scalar_type<X>>;
+            return std::same_as<typename std::remove_cvref_t<P>::accumulator_type, S>
+                and outer.count(d[0]) + outer.count(d[1]) == 1
+                and x.count(d[0]) + x.count(d[1]) == 1;
+        }
+    }();
+
+    /// The tensor operand of `T` if it's a scaled product, and `T` otherwise.
+    template <class T>
+    inline constexpr auto unscaled(T const& t)
+    {
+        if constexpr (scaled<T>) {
+            return base(t);
+        }
+        else {
+            return std::remove_cvref_t<T>(t);
+        }
+    }
+
+    /// Check to see if the scalar constants of the operands of the product `T`
+    /// can be hoisted out of it, leaving the product of their tensors.
+    ///
+    /// A contraction has to accumulate its terms in the same type afterwards,
+    /// e.g., (0.5 * A(i,k)) * B(k,j) accumulates doubles, but A(i,k) * B(k,j)
+    /// accumulates ints if A and B are ints.
+    template <class T>
+    inline constexpr bool hoists_scale = [] {
+        if constexpr (not contraction<T>) {
+            return true;
+        }
+        else {
+            using X = decltype(unscaled(std::declval<child_a<T> const&>()));
+            using Y = decltype(unscaled(std::declval<child_b<T> const&>()));
+            return std::same_as<typename std::remove_cvref_t<T>::accumulator_type, typename product<X, Y, std::multiplies {}, std::plus {}>::accumulator_type>;
+        }
+    }();
+
+    /// Rename the index that `x` contracts with the delta `d` to the other
+    /// index of `d`.
+    template <class D>
+    inline constexpr auto rename_delta(auto const& x)
+    {
+        using X = std::remove_cvref_t<decltype(x)>;
+        constexpr auto rename = [](auto str) {
+            constexpr auto d = tree::_::is_bind<D>::index;
+            std::size_t const s = str.count(d[0]) ? 0 : 1;
+            str._data[str.index_of(d[s])] = d[1 - s];
+            return str;
+        };
+        if constexpr (is_leaf<X>) {
+            constexpr auto index = rename(tree::_::is_bind<X>::index);
+            ttl::index<index> id;
+            std::ranges::copy(x._id._projected, id._projected);
+            return bind<child_a<X>, index>(x._a, id);
+        }
+        else {
+            return bind<X, rename(ttl::outer<X>)>(x);
+        }
+    }
+
+    /// The ways of factoring a term of a sum into a common factor and the rest
+    /// of the term.
+    ///
+    /// 1. `scaled`: the factor is the tensor of c * X, and the rest is c.
+    /// 2. `left`/`right`: the factor is the left (right) operand of a product.
+    /// 3. `bare`: the factor is the whole term, and the rest is 1.
+    enum class factoring {
+        none,
+        scaled,
+        left,
+        right,
+        bare
+    };
+
+    template <class T, factoring f>
+    inline constexpr bool allows = [] {
+        if constexpr (f == factoring::scaled) {
+            return scaled<T>;
+        }
+        else if constexpr (f == factoring::left or f == factoring::right) {
+            return multiplicative<T> and not scaled<T>;
+        }
+        else {
+            return f == factoring::bare;
+        }
+    }();
+
+    template <class T, factoring f>
+    struct factor_type {
+        using type = std::remove_cvref_t<T>;
+    };
+
+    template <class T>
+    struct factor_type<T, factoring::scaled> {
+        using type = decltype(base(std::declval<T const&>()));
+    };
+
+    template <class T>
+    struct factor_type<T, factoring::left> {
+        using type = std::remove_cvref_t<child_a<T>>;
+    };
+
+    template <class T>
+    struct factor_type<T, factoring::right> {
+        using type = std::remove_cvref_t<child_b<T>>;
+    };
+
+    template <class T, factoring f>
+    using factor_t = typename factor_type<T, f>::type;
+
+    /// The rest of a term after its factor, for the `left` and `right`
+    /// factorings.
+    template <class T, factoring f>
+    using rest_t = std::remove_cvref_t<std::conditional_t<f == factoring::left, child_b<T>, child_a<T>>>;
+
+    /// Check to see if the terms X and Y can be factored as F * (x + y), where
+    /// both terms have a factor with the same structure.
+    ///
+    /// Either both of the rests are scalars, e.g., 2 * A(i,j) + 3 * A(i,j),
+    /// or both are tensors with the same free indices, e.g., A(i,j) * x(j) +
+    /// A(i,j) * y(j).
+    template <class X, factoring f, class Y, factoring g>
+    inline constexpr bool factorable = [] {
+        if constexpr (not allows<X, f> or not allows<Y, g>) {
+            return false;
+        }
+        else if constexpr (not std::same_as<structure<factor_t<X, f>>, structure<factor_t<Y, g>>>) {
+            return false;
+        }
+        else {
+            constexpr bool scalar_f = f == factoring::scaled or f == factoring::bare;
+            constexpr bool scalar_g = g == factoring::scaled or g == factoring::bare;
+            if constexpr (scalar_f and scalar_g) {
+                return true;
+            }
+            else if constexpr (scalar_f or scalar_g) {
+                return false;
+            }
+            else {
+                return is_permutation(ttl::outer<rest_t<X, f>>, ttl::outer<rest_t<Y, g>>);
+            }
+        }
+    }();
+
+    /// The first pair of factorings of X and Y that are `factorable`.
+    template <class X, class Y>
+    inline constexpr auto factorings = []<std::size_t... m>(std::index_sequence<m...>) {
+        bool const ok[] { factorable<X, factoring(m / 4 + 1), Y, factoring(m % 4 + 1)>... };
+        for (std::size_t n = 0; n < sizeof...(m); ++n) {
+            if (ok[n]) {
+                return std::pair(factoring(n / 4 + 1), factoring(n % 4 + 1));
+            }
+        }
+        return std::pair(factoring::none, factoring::none);
+    }(std::make_index_sequence<16>());
+
+    template <factoring f>
+    inline constexpr auto factor_of(auto const& t)
+    {
+        if constexpr (f == factoring::scaled) {
+            return base(t);
+        }
+        else if constexpr (f == factoring::left) {
+            return std::remove_cvref_t<decltype(t._a)>(t._a);
+        }
+        else if constexpr (f == factoring::right) {
+            return std::remove_cvref_t<decltype(t._b)>(t._b);
+        }
+        else {
+            return std::remove_cvref_t<decltype(t)>(t);
+        }
+    }
+
+    template <factoring f>
+    inline constexpr auto rest_of(auto const& t)
+    {
+        if constexpr (f == factoring::left) {
+            return std::remove_cvref_t<decltype(t._b)>(t._b);
+        }
+        else {
+            return std::remove_cvref_t<decltype(t._a)>(t._a);
+        }
+    }
+
+    /// The scalar rest of a term, as a `C`.
+    template <class C, factoring f>
+    inline constexpr auto scalar_rest_of(auto const& t) -> C
+    {
+        if constexpr (f == factoring::scaled) {
+            return C(scale(t));
+        }
+        else {
+            return C(1);
+        }
+    }
+
+    inline constexpr auto simplify(auto const& t);
+
+    template <class T>
+    inline constexpr bool simplifiable = not std::same_as<decltype(simplify(std::declval<T const&>())), std::remove_cvref_t<T>>;
+
+    /// Factor the sum `t` of two terms with a common factor (see
+    /// `factorable`).
+    ///
+    /// The factors only have the same structure, so the result is an
+    /// alternative that only uses the factored sum if they read the same
+    /// leaves.
+    template <auto op>
+    inline constexpr auto factor(auto const& t)
+    {
+        using T = std::remove_cvref_t<decltype(t)>;
+        using X = child_a<T>;
+        using Y = child_b<T>;
+        constexpr auto f = factorings<X, Y>.first;
+        constexpr auto g = factorings<X, Y>.second;
+        auto const x = factor_of<f>(t._a);
+        auto const y = factor_of<g>(t._b);
+        auto const rewritten = [&] {
+            if constexpr (f == factoring::left) {
+                return multiply(x, combine<op>(rest_of<f>(t._a), rest_of<g>(t._b)));
+            }
+            else if constexpr (f == factoring::right) {
+                return multiply(combine<op>(rest_of<f>(t._a), rest_of<g>(t._b)), x);
+            }
+            else {
+                using S = std::remove_cvref_t<ttl::scalar_type<T>>;
+                return fold<S, op>(scalar_rest_of<S, f>(t._a), scalar_rest_of<S, g>(t._b));
+            }
+        }();
+        if constexpr (f == factoring::left or f == factoring::right) {
+            return alternative(simplify(rewritten), t, same_leaves(x, y));
+        }
+        else {
+            return alternative(simplify(multiply(rewritten.first, x)), t, rewritten.second and same_leaves(x, y));
+        }
+    }
+
+    /// The result `r` of a rule applied to `t`, with the outer indices of `t`.
+    ///
+    /// Some rules reorder the outer indices, e.g., 0 - A(j,i) is -A(j,i), whose
+    /// outer indices are ji rather than ij, so the simplified `r` is evaluated
+    /// through an alternative that always holds, which maps them back.
+    template <class T>
+    inline constexpr auto keep_outer(T const& t, auto const& r)
+    {
+        using R = std::remove_cvref_t<decltype(r)>;
+        if constexpr (ttl::outer<R> == ttl::outer<T>) {
+            return R(r);
+        }
+        else {
+            return alternative(simplify(r), t, true);
+        }
+    }
+
+    /// Apply the first rule that matches the root of `t`, whose children have
+    /// already been simplified, or return `t` as it is.
+    template <class T>
+    inline constexpr auto apply_rule(T const& t)
+    {
+        if constexpr (negation<T>) {
+            using X = std::remove_cvref_t<child_a<T>>;
+            if constexpr (negation<X>) {
+                // -(-X) is X
+                return std::remove_cvref_t<child_a<X>>(t._a._a);
+            }
+            else if constexpr (scaled<X>) {
+                // -(c * X) is (-c) * X
+                using S = std::remove_cvref_t<ttl::scalar_type<T>>;
+                return multiply_folded(t, fold<S, std::minus {}>(0, scale(t._a)), base(t._a));
+            }
+            else {
+                return t;
+            }
+        }
+        else if constexpr (multiplicative<T>) {
+            using X = child_a<T>;
+            using Y = child_b<T>;
+            using S = std::remove_cvref_t<ttl::scalar_type<T>>;
+            if constexpr (renames_delta<X, Y, T>) {
+                // delta(i,j) * A(j,k) is A(i,k)
+                return keep_outer(t, rename_delta<std::remove_cvref_t<X>>(t._b));
+            }
+            else if constexpr (renames_delta<Y, X, T>) {
+                return keep_outer(t, rename_delta<std::remove_cvref_t<Y>>(t._a));
+            }
+            else if constexpr (arithmetic<X> and scaled<Y>) {
+                // c * (d * X) is (c * d) * X
+                return multiply_folded(t, fold<S, std::multiplies {}>(t._a, scale(t._b)), base(t._b));
+            }
+            else if constexpr (scaled<X> and arithmetic<Y>) {
+                return multiply_folded(t, fold<S, std::multiplies {}>(scale(t._a), t._b), base(t._a));
+            }
+            else if constexpr (scaled<X> and scaled<Y> and hoists_scale<T>) {
+                // (c * X) * (d * Y) is (c * d) * (X * Y)
+                return multiply_folded(t, fold<S, std::multiplies {}>(scale(t._a), scale(t._b)), multiply(base(t._a), base(t._b)));
+            }
+            else if constexpr (contraction<T> and scaled<X> and not arithmetic<Y> and hoists_scale<T>) {
+                // (c * A(i,k)) * B(k,j) is c * (A(i,k) * B(k,j)), which
+                // multiplies each element by c rather than each term
+                return multiply(scale(t._a), multiply(base(t._a), std::remove_cvref_t<Y>(t._b)));
+            }
+            else if constexpr (contraction<T> and scaled<Y> and not arithmetic<X> and hoists_scale<T>) {
+                return multiply(scale(t._b), multiply(std::remove_cvref_t<X>(t._a), base(t._b)));
+            }
+            else {
+                return t;
+            }
+        }
+        else if constexpr (sum_with<T, std::plus<>> or sum_with<T, std::minus<>>) {
+            constexpr bool plus = sum_with<T, std::plus<>>;
+            constexpr auto op = T::_op;
+            using X = std::remove_cvref_t<child_a<T>>;
+            using Y = std::remove_cvref_t<child_b<T>>;
+            if constexpr (zero<Y>) {
+                // X + 0 is X
+                return X(t._a);
+            }
+            else if constexpr (zero<X> and plus) {
+                return keep_outer(t, Y(t._b));
+            }
+            else if constexpr (zero<X>) {
+                // 0 - X is -X
+                return keep_outer(t, unary_prefix<Y, std::negate {}>(t._b));
+            }
+            else if constexpr (negation<Y> and plus) {
+                // X + (-Y) is X - Y
+                return combine<std::minus {}>(X(t._a), std::remove_cvref_t<child_a<Y>>(t._b._a));
+            }
+            else if constexpr (negation<Y>) {
+                return combine<std::plus {}>(X(t._a), std::remove_cvref_t<child_a<Y>>(t._b._a));
+            }
+            else if constexpr (negation<X> and plus) {
+                // (-X) + Y is Y - X
+                return keep_outer(t, combine<std::minus {}>(Y(t._b), std::remove_cvref_t<child_a<X>>(t._a._a)));
+            }
+            else if constexpr (factorings<X, Y>.first != factoring::none) {
+                return factor<op>(t);
+            }
+            else {
+                return t;
+            }
+        }
+        else {
+            return t;
+        }
+    }
+
+    /// A child of a node that is being simplified. Children that don't change
+    /// are forwarded as they are, so that their declared types can be kept.
+    template <class A>
+    inline constexpr auto simplify_child(auto&& a) -> decltype(auto)
+    {
+        if constexpr (simplifiable<A>) {
+            return simplify(a);
+        }
+        else {
+            return __fwd(a);
+        }
+    }
+
+    template <class A, bool = simplifiable<A>>
+    struct simplify_type {
+        using type = A;
+    };
+
+    template <class A>
+    struct simplify_type<A, true> {
+        using type = decltype(simplify(std::declval<A const&>()));
+    };
+
+    /// The type of a child after simplification, which is its declared type if
+    /// it doesn't change.
+    template <class A>
+    using simplify_t = typename simplify_type<A>::type;
+
+    template <class T>
+    inline constexpr bool simplifies_children = [] {
+        if constexpr (binary<T>) {
+            return simplifiable<child_a<T>> or simplifiable<child_b<T>>;
+        }
+        else {
+            return simplifiable<child_a<T>>;
+        }
+    }();
+
+    /// Simplify the expression `t` with a few algebraic rules.
+    ///
+    /// The tree is simplified bottom up, and the result of each rule is
+    /// simplified again, so that rules can enable each other.
+    ///
+    /// 1. Negations cancel, -(-X) is X, and fold into scalars and sums, e.g.,
+    ///    -(2 * X) is (-2) * X and X + (-Y) is X - Y.
+    /// 2. Scalar constants are multiplied together and hoisted out of
+    ///    contractions, e.g., 2 * (3 * X) is 6 * X, and (2 * A(i,k)) * B(k,j)
+    ///    is 2 * (A(i,k) * B(k,j)), unless that changes the type the terms
+    ///    are accumulated in (see `hoists_scale`).
+    /// 3. Contractions with a delta rename an index, e.g., delta(i,j) * A(j,k)
+    ///    is A(i,k), and bound zero tensors (see `ttl::zeros`) drop out of
+    ///    sums. Results whose outer indices come out in another order are
+    ///    mapped back (see `keep_outer`).
+    /// 4. Terms with a common factor are factored, e.g., 2 * A(i,j) + 3 *
+    ///    A(i,j) is 5 * A(i,j) and A(i,j) * x(j) + A(i,j) * y(j) is A(i,j) *
+    ///    (x(j) + y(j)). The factors have to read the same leaves, so these
+    ///    build an `alternative`.
+    ///
+    /// Types that none of the rules apply to come back unchanged (see
+    /// `simplifiable`). Scalars are reassociated, so floating point results
+    /// can change in the last bits (see `TTL_REWRITE`).
+    inline constexpr auto simplify(auto const& t)
+    {
+        using T = std::remove_cvref_t<decltype(t)>;
+        if constexpr (is_leaf<T> or alternative_node<T>) {
+            return T(t);
+        }
+        else {
+            auto const n = [&] {
+                if constexpr (tree::is_bind<T>) {
+                    using X = simplify_t<child_a<T>>;
+                    return bind<X, tree::_::is_bind<T>::index>(simplify_child<child_a<T>>(t._a), t._id);
+                }
+                else if constexpr (binary<T>) {
+                    using X = simplify_t<child_a<T>>;
+                    using Y = simplify_t<child_b<T>>;
+                    return rebuild<T, X, Y>(simplify_child<child_a<T>>(t._a), simplify_child<child_b<T>>(t._b));
+                }
+                else {
+                    using X = simplify_t<child_a<T>>;
+                    return rebuild<T, X>(simplify_child<child_a<T>>(t._a));
+                }
+            };
+            if constexpr (not simplifies_children<T>) {
+                auto r = apply_rule(t);
+                if constexpr (std::same_as<decltype(r), T>) {
+                    return r;
+                }
+                else {
+                    return simplify(r);
+                }
+            }
+            else {
+                auto r = apply_rule(n());
+                if constexpr (std::same_as<decltype(r), decltype(n())>) {
+                    return r;
+                }
+                else {
+                    return simplify(r);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <ttl/evaluate.hpp>
+#include <ttl/extents.hpp>
+#include <ttl/index.hpp>
+#include <ttl/outer.hpp>
+#include <ttl/tensor.hpp>
+#include <ttl/tree/node.hpp>
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+namespace ttl::tree
+{
+    /// A prefix reduction of A along one of its outer indices, e.g.,
+    /// scan(X(i,j), j) is the cumulative sum of each row of X.
+    ///
+    /// The element at position k of the scanned index is the reduction of
+    /// elements [0, k] (inclusive) or [0, k) (exclusive). The op must be
+    /// associative, since assignments evaluate long scans in parallel blocks.
+    ///
+    /// Assignments run in linear time (see `execution_traits::_assign_scan`).
+    /// Scans inside a larger expression, or assigned in another order, e.g.,
+    /// Y(j,i) = scan(X(i,j), j), are assigned to a temporary first. Elements
+    /// that are evaluated directly reduce their prefix.
+    template <expression A, char c, auto op, bool exclusive>
+    struct scan : node {
+        using scalar_type = ttl::accumulator_type<A>;
+
+        static constexpr auto _outer = ttl::outer<A>;
+        static_assert(_outer.count(c) == 1, "Scans run along a free index.");
+
+        static constexpr std::size_t _scan_slot = _outer.index_of(c);
+        static constexpr bool _exclusive = exclusive;
+        static constexpr auto _op = op;
+
+        /// This node type with another child, e.g., for rewriting.
+        template <class X>
+        using _rebuild = scan<X, c, op, exclusive>;
+
+        /// The identity of op.
+        ///
+        /// Ops can provide it as `identity<T>()`, otherwise we use a
+        /// value-initialized accumulator, which is right for plus and or.
+        static constexpr auto _identity() -> scalar_type
+        {
+            if constexpr (requires { decltype(op)::template identity<scalar_type>(); }) {
+                return decltype(op)::template identity<scalar_type>();
+            }
+            else {
+                return scalar_type {};
+            }
+        }
+
+        A _a;
+
+        constexpr scan(A a)
+            : _a(__fwd(a))
+        {
+        }
+
+        static constexpr auto outer()
+        {
+            return _outer;
+        }
+
+        constexpr auto extents() const
+        {
+            return ttl::extents(_a);
+        }
+
+        constexpr auto operator[](std::integral auto... i) const -> scalar_type
+        {
+            static_assert(sizeof...(i) == _outer.size());
+            assert(_check_bounds(i...));
+            std::size_t ind[] { std::size_t(i)... };
+            auto const end = ind[_scan_slot] + (exclusive ? 0 : 1);
+            scalar_type accum = _identity();
+            for (std::size_t k = 0; k != end; ++k) {
+                ind[_scan_slot] = k;
+                accum = op(accum, _evaluate(ind, std::make_index_sequence<sizeof...(i)>()));
+            }
+            return accum;
+        }
+
+    private:
+        template <std::size_t... n>
+        constexpr auto _evaluate(std::size_t const (&ind)[sizeof...(n)], std::index_sequence<n...>) const
+        {
+            return ttl::evaluate(_a, ind[n]...);
+        }
+    };
+}
+
+namespace ttl
+{
+    /// The inclusive prefix reduction of `a` along `i`, e.g.,
+    /// Y(i,j) = scan(X(i,j), j), or scan<tree::maximum {}>(x(i), i) for a
+    /// running maximum.
+    template <auto op = std::plus {}, expression A, index_string str>
+    inline constexpr auto scan(A&& a, index<str>) -> tree::scan<A, str[0], op, false>
+    {
+        static_assert(str.size() == 1, "Scans run along a single index.");
+        return tree::scan<A, str[0], op, false>(__fwd(a));
+    }
+
+    /// The exclusive prefix reduction of `a` along `i`, which starts at the
+    /// identity of op and leaves out the element itself.
+    template <auto op = std::plus {}, expression A, index_string str>
+    inline constexpr auto exclusive_scan(A&& a, index<str>) -> tree::scan<A, str[0], op, true>
+    {
+        static_assert(str.size() == 1, "Scans run along a single index.");
+        return tree::scan<A, str[0], op, true>(__fwd(a));
+    }
+}
@@ -5,9 +5,11 @@
 #include <ttl/outer.hpp>
 #include <ttl/tensor.hpp>
 #include <ttl/tree/node.hpp>
+#include <ttl/tree/product.hpp>
 
 #include <concepts>
 #include <cstddef>
+#include <functional>
 #include <type_traits>
 #include <utility>
 
@@ -31,6 +33,24 @@ namespace ttl::tree
 
         static constexpr auto _rank = _outer_a.rank();
 
+        /// Check to see if this is an update of the form X(i,j) + x(i) * y(j),
+        /// where the outer product is ordered the same way as X. The assignment
+        /// engine evaluates these in a single pass.
+        static constexpr bool _rank_one_pattern = [] {
+            if constexpr (requires { requires std::remove_cvref_t<B>::_outer_pattern; }) {
+                return _outer_a == _outer_b;
+            }
+            else {
+                return false;
+            }
+        }();
+
+        static constexpr auto _op = op;
+
+        /// This node type with other children, e.g., for rewriting.
+        template <class X, class Y>
+        using _rebuild = sum<X, Y, op>;
+
         A _a;
         B _b;
 
@@ -89,6 +109,29 @@ namespace ttl::tree
         using sub::sum::sum;
     };
 
+    /// The element-wise (Hadamard) product, e.g., hadamard(A(i,j), B(i,j)).
+    ///
+    /// Unlike A(i,j) * B(i,j), the repeated indices are not contracted.
+    template <expression A, expression B>
+    struct hadamard : sum<A, B, std::multiplies {}> {
+        using hadamard::sum::sum;
+    };
+
+    /// The element-wise quotient, e.g., A(i,j) / B(j,i).
+    template <expression A, expression B>
+    struct quotient : sum<A, B, std::divides {}> {
+        using quotient::sum::sum;
+    };
+
+    /// Division by (or of) a scalar, e.g., A(i,j) / 3.
+    ///
+    /// There are no contracted indices, so this is an outer product that
+    /// divides instead of multiplying.
+    template <expression A, expression B>
+    struct div : product<A, B, std::divides {}, std::plus {}> {
+        using div::product::product;
+    };
+
     template <expression A, expression B>
     inline constexpr auto operator+(A&& a, B&& b) -> add<A, B>
     {
@@ -100,4 +143,29 @@ namespace ttl::tree
     {
         return sub<A, B>(__fwd(a), __fwd(b));
     }
+
+    template <expression A, expression B>
+        requires(rank<A> == 0 or rank<B> == 0)
+    inline constexpr auto operator/(A&& a, B&& b) -> div<A, B>
+    {
+        return div<A, B>(__fwd(a), __fwd(b));
+    }
+
+    template <expression A, expression B>
+        requires(rank<A> != 0 and rank<B> != 0)
+    inline constexpr auto operator/(A&& a, B&& b) -> quotient<A, B>
+    {
+        return quotient<A, B>(__fwd(a), __fwd(b));
+    }
+}
+
+namespace ttl
+{
+    /// The element-wise (Hadamard) product of two expressions with the same
+    /// outer indices, in any order, e.g., C(i,j) = hadamard(A(i,j), B(j,i)).
+    template <expression A, expression B>
+    inline constexpr auto hadamard(A&& a, B&& b) -> tree::hadamard<A, B>
+    {
+        return tree::hadamard<A, B>(__fwd(a), __fwd(b));
+    }
 }
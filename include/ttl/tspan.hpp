@@ -2,10 +2,12 @@
 
 #include <ttl/bind.hpp>
 #include <ttl/index.hpp>
+#include <ttl/stencil.hpp>
 #include <ttl/tensor.hpp>
 #include <ttl/tensor_traits.hpp>
 #include <ttl/tree/assign.hpp>
 
+#include <cassert>
 #include <concepts>
 #include <cstddef>
 #include <iterator>
@@ -64,6 +66,16 @@ namespace ttl
         }
         /// @}
 
+        /// Construct a tspan for a contiguous range with a layout mapping,
+        /// e.g., for padded layouts like `layout_tiled`.
+        template <class R>
+            requires std::ranges::contiguous_range<R> and std::ranges::sized_range<R>
+        constexpr tspan(R&& r, typename tspan::mapping_type const& mapping)
+            : tspan::mdspan(std::ranges::data(r), mapping)
+        {
+            assert(std::size_t(mapping.required_span_size()) <= std::ranges::size(r));
+        }
+
         /// Construct a tspan for a congtiguous iterator.
         /// @{
         constexpr tspan(std::contiguous_iterator auto it, Extents extents)
@@ -97,6 +109,16 @@ namespace ttl
             static_assert(sizeof...(i) == Extents::rank());
             return ttl::bind(typename tspan::mdspan(__fwd(self)), ttl::index(i)...);
         }
+
+        /// Tensor indexing with offset indices, e.g., X(i+1,j), which binds a
+        /// shifted view (see `ttl::shifted`).
+        constexpr auto operator()(this auto&& self, is_index auto... i)
+            -> decltype(ttl::bind(typename tspan::mdspan(__fwd(self)), i...))
+            requires(is_offset_index<decltype(i)> or ...)
+        {
+            static_assert(sizeof...(i) == Extents::rank());
+            return ttl::bind(typename tspan::mdspan(__fwd(self)), i...);
+        }
     };
 
     /// Infer the scalar type and extents for a c-array.
@@ -138,6 +160,19 @@ namespace ttl
             std::remove_reference_t<std::ranges::range_reference_t<R>>,
             std::extents<std::size_t, std::dynamic_extent, ((void)i, std::dynamic_extent)...>>;
 
+    /// Infer T as the range value type, and the extents and layout from a
+    /// layout mapping.
+    template <std::ranges::contiguous_range R, class Mapping>
+        requires requires {
+            typename Mapping::extents_type;
+            typename Mapping::layout_type;
+        }
+    tspan(R&&, Mapping const&)
+        -> tspan<
+            std::remove_reference_t<std::ranges::range_reference_t<R>>,
+            typename Mapping::extents_type,
+            typename Mapping::layout_type>;
+
     /// Infer T as the iterator value type.
     template <std::contiguous_iterator It, std_extents Extents>
     tspan(It const&, Extents const&)
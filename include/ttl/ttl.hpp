@@ -1,16 +1,31 @@
 #include <ttl/bind.hpp>
+#include <ttl/csf.hpp>
+#include <ttl/delta.hpp>
+#include <ttl/derivative.hpp>
+#include <ttl/epsilon.hpp>
 #include <ttl/evaluate.hpp>
 #include <ttl/extents.hpp>
+#include <ttl/fused.hpp>
+#include <ttl/generator.hpp>
 #include <ttl/index.hpp>
 #include <ttl/index_string.hpp>
+#include <ttl/layout.hpp>
+#include <ttl/masked.hpp>
+#include <ttl/math.hpp>
 #include <ttl/outer.hpp>
+#include <ttl/parallel.hpp>
+#include <ttl/random.hpp>
+#include <ttl/sparse.hpp>
+#include <ttl/stencil.hpp>
 #include <ttl/tensor.hpp>
 #include <ttl/tensor_traits.hpp>
 #include <ttl/tspan.hpp>
 #include <ttl/tree/assign.hpp>
 #include <ttl/tree/bind.hpp>
 #include <ttl/tree/execution_traits.hpp>
+#include <ttl/tree/function.hpp>
 #include <ttl/tree/node.hpp>
 #include <ttl/tree/negate.hpp>
 #include <ttl/tree/product.hpp>
+#include <ttl/tree/scan.hpp>
 #include <ttl/tree/sum.hpp>
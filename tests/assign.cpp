@@ -1,11 +1,18 @@
-#undef DNDEBUG
+#undef NDEBUG
+
+// A small grain, so that the run time test takes the parallel kernels.
+#define TTL_PARALLEL_GRAIN 64zu
 
 #include <ttl/ttl.hpp>
 
+#include <cstddef>
+#include <vector>
+
 using namespace ttl::literals;
 
 static constexpr auto i = "i"_id;
 static constexpr auto j = "j"_id;
+static constexpr auto k = "k"_id;
 
 static constexpr bool _scalars()
 {
@@ -92,10 +99,67 @@ static constexpr bool _tensors()
     return true;
 }
 
+static constexpr bool _masked()
+{
+    int a[6] { 1, 2, 3, 4, 5, 6 };
+    int b[6] { 6, 5, 4, 3, 2, 1 };
+    bool m[4] { true, false, false, true };
+    int c[4] { -1, -1, -1, -1 };
+    auto A = ttl::tspan(a, 2, 3);
+    auto B = ttl::tspan(b, 3, 2);
+    auto M = ttl::tspan(m, 2, 2);
+    auto C = ttl::tspan(c, 2, 2);
+
+    ttl::masked(C(i, j), M(i, j)) = A(i, k) * B(k, j);
+    assert(c[0] == 1 * 6 + 2 * 4 + 3 * 2);
+    assert(c[1] == -1);
+    assert(c[2] == -1);
+    assert(c[3] == 4 * 5 + 5 * 3 + 6 * 1);
+
+    // The mask is remapped to the output order.
+    bool n[4] { false, true, false, false };
+    auto N = ttl::tspan(n, 2, 2);
+    ttl::masked(C(i, j), N(j, i)) = A(i, k) * B(k, j);
+    assert(c[1] == -1);
+    assert(c[2] == 4 * 6 + 5 * 4 + 6 * 2);
+
+    return true;
+}
+
+/// A large masked assignment, whose rows are partitioned across threads at
+/// run time.
+static constexpr bool _parallel()
+{
+    constexpr std::size_t n = 40;
+    std::vector<int> a(n * n), m(n * n), c(n * n, -1);
+    for (std::size_t x = 0; x < n * n; ++x) {
+        a[x] = int(x % 13);
+        m[x] = (x % 3 == 0);
+    }
+    auto A = ttl::tspan(a, n, n);
+    auto M = ttl::tspan(m, n, n);
+    auto C = ttl::tspan(c, n, n);
+
+    ttl::masked(C(i, j), M(j, i)) = A(i, k) * A(k, j);
+    for (std::size_t x = 0; x < n; ++x) {
+        for (std::size_t y = 0; y < n; ++y) {
+            int z = 0;
+            for (std::size_t w = 0; w < n; ++w) {
+                z += a[n * x + w] * a[n * w + y];
+            }
+            assert(c[n * x + y] == (m[n * y + x] ? z : -1));
+        }
+    }
+
+    return true;
+}
+
 int main()
 {
     constexpr auto _ = _scalars();
     constexpr auto _ = _vectors();
     constexpr auto _ = _tensors();
+    constexpr auto _ = _masked();
+    assert(_parallel());
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#undef NDEBUG
+
+#include <ttl/ttl.hpp>
+
+#include <array>
+#include <mdspan>
+
+using namespace ttl::literals;
+
+static constexpr auto i = "i"_id;
+static constexpr auto j = "j"_id;
+static constexpr auto k = "k"_id;
+
+static constexpr bool _diagonals()
+{
+    int a[9] { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    auto A = ttl::tspan(a, 3, 3);
+    static_assert(decltype(A(i, i))::_strided);
+
+    int tr = A(i, i);
+    assert(tr == 1 + 5 + 9);
+
+    int b[36] {};
+    for (int n = 0; n < 36; ++n) {
+        b[n] = n;
+    }
+
+    // T(i,i,k) is a partial trace.
+    auto T = ttl::tspan(b, 2, 2, 6);
+    auto t = T(i, i, k);
+    for (int n = 0; n < 6; ++n) {
+        assert(t[n] == b[n] + b[3 * 6 + n]);
+    }
+
+    // U(k,i,i) contracts the trailing slots.
+    auto U = ttl::tspan(b, 6, 2, 2);
+    auto u = U(k, i, i);
+    for (int n = 0; n < 6; ++n) {
+        assert(u[n] == b[4 * n] + b[4 * n + 3]);
+    }
+
+    // A contraction around a projection.
+    auto V = ttl::tspan(b, 2, 3, 2, 3);
+    auto v = V(i, 1, i, j);
+    for (int n = 0; n < 3; ++n) {
+        int x = 0;
+        for (int m = 0; m < 2; ++m) {
+            x += b[((m * 3 + 1) * 2 + m) * 3 + n];
+        }
+        assert(v[n] == x);
+    }
+
+    // Two contractions.
+    int w = V(i, j, i, j);
+    int x = 0;
+    for (int n = 0; n < 2; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            x += b[((n * 3 + m) * 2 + n) * 3 + m];
+        }
+    }
+    assert(w == x);
+
+    // A layout_left tensor walks the same diagonal with different strides.
+    auto L = std::mdspan<int, std::dextents<std::size_t, 3>, std::layout_left>(b, 2, 3, 2);
+    auto l = ttl::bind(std::move(L), i, k, i);
+    for (int n = 0; n < 3; ++n) {
+        assert(l[n] == b[2 * n] + b[1 + 2 * n + 6]);
+    }
+
+    // A layout_stride view picks every other element of a.
+    std::array<std::size_t, 2> strides { 4, 2 };
+    auto S = std::mdspan(a, std::layout_stride::mapping<std::dextents<std::size_t, 2>>(std::dextents<std::size_t, 2>(2, 2), strides));
+    int s = ttl::bind(std::move(S), i, i);
+    assert(s == a[0] + a[6]);
+
+    return true;
+}
+
+static constexpr bool _projections()
+{
+    int b[24] {};
+    for (int n = 0; n < 24; ++n) {
+        b[n] = n;
+    }
+
+    // Projections of a strided tensor are bound as lower rank views.
+    auto B = ttl::tspan(b, 2, 3, 4);
+    static_assert(ttl::tree::matrix_bind<decltype(B(i, 1, j))>);
+    static_assert(decltype(B(i, 1, j))::_strided);
+
+    auto p = B(1, i, 2);
+    static_assert(ttl::tensor<decltype(p)>);
+    for (int n = 0; n < 3; ++n) {
+        assert(p[n] == b[12 + 4 * n + 2]);
+    }
+
+    int x[4] { 1, 2, 3, 4 };
+    int z[4] {};
+    auto X = ttl::tspan(x);
+    auto Z = ttl::tspan(z);
+    Z(i) = X(i) + B(1, 2, i);
+    for (int n = 0; n < 4; ++n) {
+        assert(z[n] == x[n] + b[12 + 8 + n]);
+    }
+
+    // Writes go through the view to the original storage.
+    B(0, i, j) = 2 * B(1, i, j);
+    for (int n = 0; n < 12; ++n) {
+        assert(b[n] == 2 * b[12 + n]);
+    }
+
+    // Contractions compose with projections.
+    int c[18] {};
+    for (int n = 0; n < 18; ++n) {
+        c[n] = n;
+    }
+    auto C = ttl::tspan(c, 3, 2, 3);
+    int t = C(i, 1, i);
+    assert(t == c[3] + c[6 + 3 + 1] + c[12 + 3 + 2]);
+
+    return true;
+}
+
+int main()
+{
+    constexpr bool _ = _diagonals();
+    constexpr bool _ = _projections();
+    return 0;
+}
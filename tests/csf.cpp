@@ -0,0 +1,191 @@
+#undef NDEBUG
+
+// A small grain, so that the run time test takes the parallel kernels.
+#define TTL_PARALLEL_GRAIN 64zu
+
+#include <ttl/ttl.hpp>
+
+#include <cstddef>
+#include <vector>
+
+using namespace ttl::literals;
+
+static constexpr auto i = "i"_id;
+static constexpr auto j = "j"_id;
+static constexpr auto k = "k"_id;
+static constexpr auto r = "r"_id;
+
+// The dense version of the sparse tensor used in the tests.
+static constexpr int dense[3][3][2] {
+    { { 0, 1 }, { 0, 0 }, { 2, 3 } },
+    { { 0, 0 }, { 0, 0 }, { 0, 0 } },
+    { { 0, 0 }, { 4, 0 }, { 0, 5 } },
+};
+
+static constexpr bool _csf()
+{
+    int v[5] { 1, 2, 3, 4, 5 };
+    std::size_t const f0[2] { 0, 2 };
+    std::size_t const p0[3] { 0, 2, 4 };
+    std::size_t const f1[4] { 0, 2, 1, 2 };
+    std::size_t const p1[5] { 0, 1, 3, 4, 5 };
+    std::size_t const f2[5] { 1, 0, 1, 0, 1 };
+    auto X = ttl::csf_span<int, 3>(v, { p0, p1 }, { f0, f1, f2 }, std::dextents<std::size_t, 3>(3, 3, 2));
+
+    static_assert(ttl::tensor<decltype(X)>);
+    assert(X.nonzeros() == 5);
+    for (int a = 0; a < 3; ++a) {
+        for (int b = 0; b < 3; ++b) {
+            for (int c = 0; c < 2; ++c) {
+                assert(ttl::evaluate(X, a, b, c) == dense[a][b][c]);
+            }
+        }
+    }
+
+    // Bound CSF tensors work in ordinary expressions.
+    int z[6] { 1, 2, 3, 4, 5, 6 };
+    int y[3] {};
+    auto Z = ttl::tspan(z, 3, 2);
+    auto Y = ttl::tspan(y);
+    Y(i) = X(i, j, k) * Z(j, k);
+    for (int a = 0; a < 3; ++a) {
+        int w = 0;
+        for (int b = 0; b < 3; ++b) {
+            for (int c = 0; c < 2; ++c) {
+                w += dense[a][b][c] * z[2 * b + c];
+            }
+        }
+        assert(y[a] == w);
+    }
+
+    return true;
+}
+
+static constexpr bool _mttkrp()
+{
+    int v[5] { 1, 2, 3, 4, 5 };
+    std::size_t const f0[2] { 0, 2 };
+    std::size_t const p0[3] { 0, 2, 4 };
+    std::size_t const f1[4] { 0, 2, 1, 2 };
+    std::size_t const p1[5] { 0, 1, 3, 4, 5 };
+    std::size_t const f2[5] { 1, 0, 1, 0, 1 };
+    auto X = ttl::csf_span<int, 3>(v, { p0, p1 }, { f0, f1, f2 }, std::dextents<std::size_t, 3>(3, 3, 2));
+
+    int a[6] { 1, 2, 3, 4, 5, 6 };
+    int b[6] { 2, 1, 0, 3, 1, 1 };
+    int c[4] { 1, 3, 2, 1 };
+    auto A = ttl::tspan(a, 3, 2);
+    auto B = ttl::tspan(b, 3, 2);
+    auto C = ttl::tspan(c, 2, 2);
+
+    // The root mode.
+    int m[6] { -1, -1, -1, -1, -1, -1 };
+    auto M = ttl::tspan(m, 3, 2);
+    ttl::mttkrp(M(i, r), X(i, j, k), B(j, r), C(k, r));
+    for (int x = 0; x < 3; ++x) {
+        for (int s = 0; s < 2; ++s) {
+            int w = 0;
+            for (int y = 0; y < 3; ++y) {
+                for (int z = 0; z < 2; ++z) {
+                    w += dense[x][y][z] * b[2 * y + s] * c[2 * z + s];
+                }
+            }
+            assert(m[2 * x + s] == w);
+        }
+    }
+
+    // An inner mode, with the factors in a different order.
+    ttl::mttkrp(M(j, r), X(i, j, k), C(k, r), A(i, r));
+    for (int y = 0; y < 3; ++y) {
+        for (int s = 0; s < 2; ++s) {
+            int w = 0;
+            for (int x = 0; x < 3; ++x) {
+                for (int z = 0; z < 2; ++z) {
+                    w += dense[x][y][z] * a[2 * x + s] * c[2 * z + s];
+                }
+            }
+            assert(m[2 * y + s] == w);
+        }
+    }
+
+    // The leaf mode, with transposed bindings.
+    int n[4] {};
+    auto N = ttl::tspan(n, 2, 2);
+    auto Aʹ = ttl::tspan(a, 2, 3);
+    ttl::mttkrp(N(r, k), X(i, j, k), Aʹ(r, i), B(j, r));
+    for (int z = 0; z < 2; ++z) {
+        for (int s = 0; s < 2; ++s) {
+            int w = 0;
+            for (int x = 0; x < 3; ++x) {
+                for (int y = 0; y < 3; ++y) {
+                    w += dense[x][y][z] * a[3 * s + x] * b[2 * y + s];
+                }
+            }
+            assert(n[2 * s + z] == w);
+        }
+    }
+
+    return true;
+}
+
+/// A larger tensor, so that the roots of the root mode MTTKRP are partitioned
+/// across threads at run time.
+static constexpr bool _parallel()
+{
+    // The 60 x 6 x 5 tensor with x(a,b,c) = a + b - c where a + b + c is a
+    // multiple of 3.
+    constexpr std::size_t n0 = 60, n1 = 6, n2 = 5;
+    auto const dense = [](std::size_t a, std::size_t b, std::size_t c) {
+        return (a + b + c) % 3 == 0 ? int(a + b) - int(c) : 0;
+    };
+    std::vector<int> v;
+    std::vector<std::size_t> f0, f1, f2, p0 { 0 }, p1 { 0 };
+    for (std::size_t a = 0; a < n0; ++a) {
+        f0.push_back(a);
+        for (std::size_t b = 0; b < n1; ++b) {
+            f1.push_back(b);
+            for (std::size_t c = 0; c < n2; ++c) {
+                if (dense(a, b, c)) {
+                    v.push_back(dense(a, b, c));
+                    f2.push_back(c);
+                }
+            }
+            p1.push_back(f2.size());
+        }
+        p0.push_back(f1.size());
+    }
+    auto X = ttl::csf_span<int, 3>(v, { p0, p1 }, { f0, f1, f2 }, std::dextents<std::size_t, 3>(n0, n1, n2));
+
+    std::vector<int> b(n1 * 2), c(n2 * 2), m(n0 * 2, -1);
+    for (std::size_t y = 0; y < n1 * 2; ++y) {
+        b[y] = int(y % 4) - 1;
+    }
+    for (std::size_t z = 0; z < n2 * 2; ++z) {
+        c[z] = int(z % 3) + 1;
+    }
+    auto B = ttl::tspan(b, n1, 2);
+    auto C = ttl::tspan(c, n2, 2);
+    auto M = ttl::tspan(m, n0, 2);
+    ttl::mttkrp(M(i, r), X(i, j, k), B(j, r), C(k, r));
+    for (std::size_t x = 0; x < n0; ++x) {
+        for (std::size_t s = 0; s < 2; ++s) {
+            int w = 0;
+            for (std::size_t y = 0; y < n1; ++y) {
+                for (std::size_t z = 0; z < n2; ++z) {
+                    w += dense(x, y, z) * b[2 * y + s] * c[2 * z + s];
+                }
+            }
+            assert(m[2 * x + s] == w);
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    constexpr bool _ = _csf();
+    constexpr bool _ = _mttkrp();
+    assert(_parallel());
+    return 0;
+}
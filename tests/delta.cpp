@@ -0,0 +1,121 @@
+#undef NDEBUG
+
+#include <ttl/ttl.hpp>
+
+#include <cstddef>
+
+using namespace ttl::literals;
+
+static constexpr auto i = "i"_id;
+static constexpr auto j = "j"_id;
+static constexpr auto k = "k"_id;
+
+static constexpr bool _delta()
+{
+    auto const d = ttl::delta<3>(i, j);
+    static_assert(ttl::extents_type<decltype(d)>::static_extent(0) == 3);
+    for (int n = 0; n < 3; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            assert((d[n, m]) == (n == m));
+        }
+    }
+
+    int a[9] { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    int b[9] {};
+    auto A = ttl::tspan(a, 3, 3);
+    auto B = ttl::tspan(b, 3, 3);
+
+    // Contractions with a delta are renames.
+    static_assert(decltype(ttl::delta<3>(i, j) * A(j, k))::_diagonal_bound<2>.active);
+    B(i, k) = ttl::delta<3>(i, j) * A(j, k);
+    for (int n = 0; n < 9; ++n) {
+        assert(b[n] == a[n]);
+    }
+
+    B(i, k) = A(i, j) * ttl::delta(3)(k, j);
+    for (int n = 0; n < 9; ++n) {
+        assert(b[n] == a[n]);
+    }
+
+    B(i, j) = A(k, i) * ttl::delta<3>(j, k);
+    for (int n = 0; n < 3; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            assert(b[3 * n + m] == a[3 * m + n]);
+        }
+    }
+
+    // Traces only visit the diagonal.
+    assert(int(ttl::delta<3>(i, j) * A(i, j)) == 15);
+    assert(int(A(j, i) * ttl::delta(3)(i, j)) == 15);
+    assert(int(ttl::delta<3>(i, i)) == 3);
+
+    B(i, k) = ttl::delta<3>(i, j) * ttl::delta<3>(j, k);
+    for (int n = 0; n < 3; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            assert(b[3 * n + m] == (n == m));
+        }
+    }
+
+    // The deviatoric part only evaluates the trace on the diagonal.
+    B(i, j) = 3 * A(i, j) - A(k, k) * ttl::delta<3>(i, j);
+    assert(b[0] + b[4] + b[8] == 0);
+    assert(b[1] == 6 and b[5] == 18 and b[0] == 3 - 15);
+
+    auto const e = A(k, k) * ttl::delta<3>(i, j);
+    assert((e[0, 1]) == 0 and (e[2, 2]) == 15);
+
+    return true;
+}
+
+static constexpr bool _diagonal()
+{
+    int x[3] { 1, 2, 3 };
+    int a[6] { 1, 2, 3, 4, 5, 6 };
+    int b[6] {};
+    auto A = ttl::tspan(a, 3, 2);
+    auto B = ttl::tspan(b, 3, 2);
+    auto D = ttl::diagonal(x);
+
+    static_assert(ttl::tensor<decltype(D)>);
+    assert((D[1, 1]) == 2 and (D[1, 2]) == 0);
+
+    // Products are row and column scalings.
+    static_assert(decltype(D(i, j) * A(j, k))::_diagonal_bound<2>.active);
+    B(i, k) = D(i, j) * A(j, k);
+    for (int n = 0; n < 3; ++n) {
+        for (int m = 0; m < 2; ++m) {
+            assert(b[2 * n + m] == x[n] * a[2 * n + m]);
+        }
+    }
+
+    int c[6] {};
+    auto C = ttl::tspan(c, 2, 3);
+    C(k, i) = A(j, k) * D(j, i);
+    for (int n = 0; n < 3; ++n) {
+        for (int m = 0; m < 2; ++m) {
+            assert(c[3 * m + n] == x[n] * a[2 * n + m]);
+        }
+    }
+
+    // Diagonal matrices can wrap any rank-1 tensor.
+    int y[3] { 2, 0, -1 };
+    auto Y = ttl::tspan(y);
+    int s[9] {};
+    auto S = ttl::tspan(s, 3, 3);
+    S(i, k) = D(i, j) * ttl::diagonal(Y)(j, k);
+    for (int n = 0; n < 3; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            assert(s[3 * n + m] == (n == m ? x[n] * y[n] : 0));
+        }
+    }
+    assert(int(D(i, j) * S(j, i)) == 2 - 9);
+
+    return true;
+}
+
+int main()
+{
+    constexpr bool _ = _delta();
+    constexpr bool _ = _diagonal();
+    return 0;
+}
@@ -0,0 +1,146 @@
+#undef NDEBUG
+
+#include <ttl/ttl.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <mdspan>
+
+using namespace ttl::literals;
+
+static constexpr auto i = "i"_id;
+static constexpr auto j = "j"_id;
+static constexpr auto k = "k"_id;
+static constexpr auto l = "l"_id;
+
+static constexpr bool near(double a, double b, double ulps = 4)
+{
+    double const d = a - b;
+    double const e = (b < 0 ? -b : b) * std::numeric_limits<double>::epsilon() * ulps;
+    return -e <= d and d <= e;
+}
+
+static constexpr bool _energy()
+{
+    double f[4] { 1, 2, 3, 4 };
+    double c[16] {};
+    double d[4] {};
+    for (int n = 0; n < 16; ++n) {
+        c[n] = n % 5;
+    }
+    auto F = ttl::tspan(f, 2, 2);
+    auto C = ttl::tspan(c, 2, 2, 2, 2);
+    auto dW = ttl::tspan(d, 2, 2);
+
+    // dW(k,l) = 0.5 * (C(i,j,k,l) + C(k,l,i,j)) * F(i,j)
+    auto const W = 0.5 * F(i, j) * C(i, j, k, l) * F(k, l);
+    dW(k, l) = ttl::grad(W, F(k, l));
+    for (int a = 0; a < 2; ++a) {
+        for (int b = 0; b < 2; ++b) {
+            double e = 0;
+            for (int p = 0; p < 2; ++p) {
+                for (int q = 0; q < 2; ++q) {
+                    e += 0.5 * (C[p, q, a, b] + C[a, b, p, q]) * F[p, q];
+                }
+            }
+            assert((dW[a, b] == e));
+        }
+    }
+
+    // Contracted indices contribute deltas.
+    dW(k, l) = ttl::grad(F(i, i), F(k, l));
+    assert(d[0] == 1 and d[1] == 0 and d[2] == 0 and d[3] == 1);
+    dW(k, l) = ttl::grad(F(i, j) * F(j, i), F(k, l));
+    assert(d[0] == 2 and d[1] == 6 and d[2] == 4 and d[3] == 8);
+
+    // Rewrites of the expression keep the order of its outer indices.
+    double a[4] { 1, 2, 3, 4 };
+    double b[4] { 5, 6, 7, 8 };
+    auto A = ttl::tspan(a, 2, 2);
+    auto B = ttl::tspan(b, 2, 2);
+    dW(k, l) = ttl::grad(F(j, i) * ((-A(j, i)) + B(i, j)), F(k, l));
+    assert(d[0] == 4 and d[1] == 5 and d[2] == 3 and d[3] == 4);
+    dW(k, l) = ttl::grad(F(i, j) * (ttl::zeros(2, 2)(i, j) - A(j, i)), F(k, l));
+    assert(d[0] == -1 and d[1] == -3 and d[2] == -2 and d[3] == -4);
+
+    // Projected slots contribute an indicator, and projections of other
+    // tensors of the same type don't contribute.
+    dW(k, l) = ttl::grad(F(i, j) * A(i, 0) * A(0, j), F(k, l));
+    assert(d[0] == 1 and d[1] == 2 and d[2] == 3 and d[3] == 6);
+    double m[4] { 1, 2, 3, 4 };
+    auto const Z = ttl::tspan(m, ttl::layout_morton::mapping<std::dextents<std::size_t, 2>>(std::dextents<std::size_t, 2>(2, 2)));
+    dW(k, l) = ttl::grad(Z(i, 0) * B(i, 1), Z(k, l));
+    assert(d[0] == 6 and d[1] == 0 and d[2] == 8 and d[3] == 0);
+    dW(k, l) = ttl::grad(Z(1, i) * Z(i, 0), Z(k, l));
+    assert(d[0] == 3 and d[1] == 0 and d[2] == 5 and d[3] == 3);
+
+    // Projections of strided tensors are bound to views, which can't be
+    // differentiated.
+    assert(ttl::tree::_::reads_view(F(i, 0) * B(i, 1), F(k, l)._a));
+    assert(not ttl::tree::_::reads_view(F(i, j) * A(i, 0) * A(0, j), F(k, l)._a));
+    return true;
+}
+
+static constexpr bool _chain_rule()
+{
+    double x[2] { 1, 2 };
+    double y[2] { 3, 5 };
+    double u[2] { 3, 4 };
+    double d[2] {};
+    int n[2] { 1, 1 };
+    auto X = ttl::tspan(x);
+    auto Y = ttl::tspan(y);
+    auto U = ttl::tspan(u);
+    auto D = ttl::tspan(d);
+    auto N = ttl::tspan(n);
+
+    // Leaves of the same type only contribute if they read the tensor.
+    D(k) = ttl::grad(X(i) * Y(i), X(k));
+    assert(d[0] == 3 and d[1] == 5);
+    D(k) = ttl::grad(X(i) * Y(i), Y(k));
+    assert(d[0] == 1 and d[1] == 2);
+    D(k) = ttl::grad(X(i) * X(i), X(k));
+    assert(d[0] == 2 and d[1] == 4);
+    D(k) = ttl::grad(2 * Y(i) * Y(i), X(k));
+    assert(d[0] == 0 and d[1] == 0);
+    D(k) = ttl::grad(N(i) * Y(i), X(k));
+    assert(d[0] == 0 and d[1] == 0);
+
+    // Sums, differences and rebound expressions.
+    D(k) = ttl::grad((X(i) - Y(i)) * (X(i) - Y(i)), Y(k));
+    assert(d[0] == 4 and d[1] == 6);
+    auto const Z = X(i) + Y(i);
+    D(k) = ttl::grad(Z(j) * Y(j), X(k));
+    assert(d[0] == 3 and d[1] == 5);
+
+    // Element-wise quotients, powers and functions.
+    D(k) = ttl::grad(X(i) / Y(i) * X(i), X(k));
+    assert(near(d[0], 2.0 / 3) and near(d[1], 0.8));
+    D(k) = ttl::grad(X(i) / Y(i) * X(i), Y(k));
+    assert(near(d[0], -1.0 / 9) and near(d[1], -0.16));
+    D(k) = ttl::grad(X(i) / 2.0 * Y(i), X(k));
+    assert(d[0] == 1.5 and d[1] == 2.5);
+    D(k) = ttl::grad(2.0 / X(i) * Y(i), X(k));
+    assert(d[0] == -6 and d[1] == -2.5);
+    D(j) = ttl::grad(Y(i) / (X(k) * X(k)) * Y(i), X(j));
+    assert(near(d[0], -2.72) and near(d[1], -5.44));
+    D(j) = ttl::grad((X(k) * X(k)) / Y(i) * Y(i), X(j));
+    assert(near(d[0], 4) and near(d[1], 8));
+    D(k) = ttl::grad(ttl::pow(X(i), 3) * Y(i), X(k));
+    assert(d[0] == 9 and d[1] == 60);
+    D(k) = ttl::grad(-ttl::sqrt(U(i) * U(i)), U(k));
+    assert(near(d[0], -0.6) and near(d[1], -0.8));
+    D(k) = ttl::grad(ttl::exp(X(i)) * Y(i), X(k));
+    assert(near(d[0], 3 * ttl::math::exp(1.0)) and near(d[1], 5 * ttl::math::exp(2.0)));
+    D(k) = ttl::grad(ttl::log(X(i)) * Y(i), X(k));
+    assert(near(d[0], 3) and near(d[1], 2.5));
+    D(k) = ttl::grad(ttl::abs(-X(i)) * Y(i), X(k));
+    assert(d[0] == 3 and d[1] == 5);
+    return true;
+}
+
+int main()
+{
+    constexpr bool _ = _energy();
+    constexpr bool _ = _chain_rule();
+}
@@ -0,0 +1,72 @@
+#undef NDEBUG
+
+#include <ttl/ttl.hpp>
+
+#include <cstddef>
+
+using namespace ttl::literals;
+
+static constexpr auto i = "i"_id;
+static constexpr auto j = "j"_id;
+static constexpr auto k = "k"_id;
+static constexpr auto l = "l"_id;
+
+static constexpr bool _epsilon()
+{
+    auto const e = ttl::epsilon(i, j, k);
+    static_assert(ttl::extents_type<decltype(e)>::static_extent(2) == 3);
+    assert((e[0, 1, 2]) == 1 and (e[1, 2, 0]) == 1 and (e[2, 1, 0]) == -1 and (e[0, 0, 1]) == 0);
+
+    auto const e2 = ttl::epsilon(i, j);
+    assert((e2[0, 1]) == 1 and (e2[1, 0]) == -1 and (e2[1, 1]) == 0);
+
+    // Cross products only visit the nonzero permutations.
+    int a[3] { 1, 2, 3 };
+    int b[3] { 4, 5, 6 };
+    int c[3] {};
+    auto A = ttl::tspan(a);
+    auto B = ttl::tspan(b);
+    auto C = ttl::tspan(c);
+    static_assert(decltype(ttl::epsilon(i, j, k) * A(j))::_levi_civita_bound<2>.active);
+    C(i) = ttl::epsilon(i, j, k) * A(j) * B(k);
+    assert(c[0] == 2 * 6 - 3 * 5 and c[1] == 3 * 4 - 1 * 6 and c[2] == 1 * 5 - 2 * 4);
+
+    C(k) = A(i) * B(j) * ttl::epsilon(i, j, k);
+    assert(c[0] == -3 and c[1] == 6 and c[2] == -3);
+
+    // The axial vector of a matrix.
+    int m[9] { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    auto M = ttl::tspan(m, 3, 3);
+    C(i) = ttl::epsilon(i, j, k) * M(j, k);
+    assert(c[0] == 6 - 8 and c[1] == 7 - 3 and c[2] == 2 - 4);
+
+    // epsilon(i,j,k) * epsilon(l,j,k) = 2 delta(i,l)
+    int d[9] {};
+    auto D = ttl::tspan(d, 3, 3);
+    D(i, l) = ttl::epsilon(i, j, k) * ttl::epsilon(l, j, k);
+    for (int n = 0; n < 3; ++n) {
+        for (int p = 0; p < 3; ++p) {
+            assert(d[3 * n + p] == 2 * (n == p));
+        }
+    }
+
+    // Rotations in two dimensions.
+    int x[2] { 3, 4 };
+    int y[2] {};
+    auto X = ttl::tspan(x);
+    auto Y = ttl::tspan(y);
+    Y(i) = ttl::epsilon(i, j) * X(j);
+    assert(y[0] == 4 and y[1] == -3);
+
+    // Repeated outer indices are structural zeros.
+    auto const f = ttl::epsilon(i, j, k) * A(l);
+    assert((f[1, 1, 0, 2]) == 0 and (f[1, 2, 0, 2]) == 3);
+
+    return true;
+}
+
+int main()
+{
+    constexpr bool _ = _epsilon();
+    return 0;
+}
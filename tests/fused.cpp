@@ -0,0 +1,289 @@
+#undef NDEBUG
+
+// A small grain, so that the run time test takes the parallel kernels.
+#define TTL_PARALLEL_GRAIN 64zu
+
+#include <ttl/ttl.hpp>
+
+#include <cstddef>
+#include <mdspan>
+#include <vector>
+
+using namespace ttl::literals;
+
+static constexpr auto i = "i"_id;
+static constexpr auto j = "j"_id;
+static constexpr auto k = "k"_id;
+
+template <class Layout>
+using matrix = ttl::tspan<int, std::dextents<std::size_t, 2>, Layout>;
+
+static constexpr bool _matrix_vector()
+{
+    int a[6] { 1, 2, 3, 4, 5, 6 };
+    int x[3] { 1, 0, -1 };
+    int w[2] { 2, 1 };
+    int y[2] {};
+    int z[3] {};
+    auto A = ttl::tspan(a, 2, 3);
+    auto X = ttl::tspan(x);
+    auto W = ttl::tspan(w);
+    auto Y = ttl::tspan(y);
+    auto Z = ttl::tspan(z);
+
+    ttl::assign_all(ttl::defer(Y(i)) = A(i, j) * X(j),
+                    ttl::defer(Z(j)) = A(i, j) * W(i));
+    assert(y[0] == -2 and y[1] == -2);
+    assert(z[0] == 6 and z[1] == 9 and z[2] == 12);
+
+    // The outputs are overwritten and the statements can be element-wise.
+    int b[6] {};
+    auto B = ttl::tspan(b, 3, 2);
+    ttl::assign_all(ttl::defer(Z(j)) = W(i) * A(i, j),
+                    ttl::defer(B(j, i)) = 2 * A(i, j));
+    assert(z[0] == 6 and z[1] == 9 and z[2] == 12);
+    for (int n = 0; n < 2; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            assert(b[2 * m + n] == 2 * a[3 * n + m]);
+        }
+    }
+
+    return true;
+}
+
+static constexpr bool _moments()
+{
+    double x[5] { 1, 2, 3, 4, 5 };
+    auto X = ttl::tspan(x);
+    double sum = -1;
+    double squares = -1;
+    ttl::assign_all(ttl::defer(sum) = X(i) * ttl::fill(1.0, 5)(i),
+                    ttl::defer(squares) = X(i) * X(i));
+    assert(sum == 15);
+    assert(squares == 55);
+
+    return true;
+}
+
+static constexpr bool _semiring()
+{
+    int a[4] { 1, 5, 2, 0 };
+    int b[4] { 0, 3, 1, 4 };
+    int c[4] {};
+    int d[4] {};
+    auto A = ttl::tspan(a, 2, 2);
+    auto B = ttl::tspan(b, 2, 2);
+    auto C = ttl::tspan(c, 2, 2);
+    auto D = ttl::tspan(d, 2, 2);
+
+    ttl::assign_all(ttl::defer(C(i, j)) = ttl::min_plus(A(i, k), B(k, j)),
+                    ttl::defer(D(i, j)) = A(i, k) * B(k, j));
+    assert(c[0] == 1 and c[1] == 4 and c[2] == 1 and c[3] == 4);
+    assert(d[0] == 5 and d[1] == 23 and d[2] == 0 and d[3] == 6);
+
+    return true;
+}
+
+static constexpr bool _program()
+{
+    double a[4] { 1, 2, 3, 4 };
+    double b[4] { 4, 3, 2, 1 };
+    double c[4] { 1, 1, 1, 1 };
+    double t[4] {};
+    double u[4] {};
+    double v[4] {};
+    double s = 2;
+    auto A = ttl::tspan(a);
+    auto B = ttl::tspan(b);
+    auto C = ttl::tspan(c);
+    auto T = ttl::tspan(t);
+    auto U = ttl::tspan(u);
+    auto V = ttl::tspan(v);
+
+    auto step = ttl::record(ttl::defer(T(i)) = A(i) + B(i),
+                            ttl::defer(U(i)) = T(i) * s,
+                            ttl::defer(V(i)) = U(i) - C(i));
+    step.flush();
+    for (int n = 0; n < 4; ++n) {
+        assert(t[n] == 5 and u[n] == 10 and v[n] == 9);
+    }
+
+    // The program reads the current values each time it's flushed.
+    s = 3;
+    step.flush();
+    for (int n = 0; n < 4; ++n) {
+        assert(u[n] == 15 and v[n] == 14);
+    }
+
+    // Intermediates that aren't needed later can stay expressions.
+    auto w = A(i) + B(i);
+    ttl::record(ttl::defer(U(i)) = w * s, ttl::defer(V(i)) = w - C(i)).flush();
+    for (int n = 0; n < 4; ++n) {
+        assert(u[n] == 15 and v[n] == 4);
+    }
+
+    // A contraction is complete before it's read.
+    double total = 0;
+    ttl::record(ttl::defer(total) = A(i) * ttl::fill(1.0, 4)(i),
+                ttl::defer(V(i)) = A(i) / total,
+                ttl::defer(U(i)) = V(i) * 10.0)
+        .flush();
+    assert(total == 10);
+    for (int n = 0; n < 4; ++n) {
+        assert(v[n] == a[n] / 10 and u[n] == a[n]);
+    }
+
+    return true;
+}
+
+static constexpr bool _dependencies()
+{
+    int m[6] { 1, 2, 3, 4, 5, 6 };
+    int x[6] {};
+    int y[6] {};
+    int z[6] {};
+    auto M = ttl::tspan(m, 2, 3);
+    auto X = ttl::tspan(x, 2, 3);
+    auto Y = ttl::tspan(y, 3, 2);
+    auto Z = ttl::tspan(z, 2, 3);
+
+    // The transposed read of X needs all of X, and the second write to X
+    // must follow the read of it.
+    ttl::record(ttl::defer(X(i, j)) = 3 * M(i, j),
+                ttl::defer(Y(j, i)) = X(i, j) * 2,
+                ttl::defer(Z(i, j)) = ttl::tspan(y, 2, 3)(i, j) - X(i, j),
+                ttl::defer(X(i, j)) = -1 * M(i, j))
+        .flush();
+    for (int n = 0; n < 2; ++n) {
+        for (int k = 0; k < 3; ++k) {
+            assert(x[3 * n + k] == -m[3 * n + k]);
+            assert(y[2 * k + n] == 6 * m[3 * n + k]);
+            assert(z[3 * n + k] == y[3 * n + k] - 3 * m[3 * n + k]);
+        }
+    }
+
+    // Scans and stencils are executed on their own.
+    int p[4] { 1, 2, 3, 4 };
+    int q[4] {};
+    int r[4] {};
+    auto P = ttl::tspan(p);
+    auto Q = ttl::tspan(q);
+    auto R = ttl::tspan(r);
+    ttl::record(ttl::defer(Q(i)) = ttl::scan(P(i), i),
+                ttl::defer(R(i)) = Q(i + 1) - Q(i),
+                ttl::defer(P(i)) = Q(i) * 2)
+        .flush();
+    assert(q[0] == 1 and q[1] == 3 and q[2] == 6 and q[3] == 10);
+    assert(r[0] == 2 and r[1] == 3 and r[2] == 4 and r[3] == 0);
+    assert(p[0] == 2 and p[3] == 20);
+
+    return true;
+}
+
+static constexpr bool _packed()
+{
+    int a[9] { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    int d[9] {};
+    int l[7] {};
+    int s[6] {};
+    int v[6] {};
+    auto A = ttl::tspan(a, 3, 3);
+    auto D = ttl::tspan(d, 3, 3);
+    auto L = matrix<ttl::layout_packed_lower>(l, 3, 3);
+    auto S = matrix<ttl::layout_packed_symmetric>(s, 3, 3);
+    auto V = matrix<ttl::layout_voigt>(v, 3, 3);
+
+    // Packed outputs don't store every element, so they're assigned on their
+    // own, with the same results as an ordinary assignment.
+    static_assert(not decltype(ttl::defer(L(i, j)) = A(i, j))::_pointwise);
+    static_assert(not decltype(ttl::defer(S(i, j)) = A(i, j))::_pointwise);
+    static_assert(not decltype(ttl::defer(V(i, j)) = A(i, j))::_pointwise);
+    ttl::record(ttl::defer(D(i, j)) = 2 * A(i, j),
+                ttl::defer(L(i, j)) = A(i, j) + A(j, i),
+                ttl::defer(S(i, j)) = A(i, j),
+                ttl::defer(V(i, j)) = A(i, j) - D(j, i))
+        .flush();
+
+    int el[7] {};
+    int es[6] {};
+    int ev[6] {};
+    auto EL = matrix<ttl::layout_packed_lower>(el, 3, 3);
+    auto ES = matrix<ttl::layout_packed_symmetric>(es, 3, 3);
+    auto EV = matrix<ttl::layout_voigt>(ev, 3, 3);
+    EL(i, j) = A(i, j) + A(j, i);
+    ES(i, j) = A(i, j);
+    EV(i, j) = A(i, j) - D(j, i);
+    for (int n = 0; n < 9; ++n) {
+        assert(d[n] == 2 * a[n]);
+    }
+    for (int n = 0; n < 7; ++n) {
+        assert(l[n] == el[n]);
+    }
+    assert(l[6] == 0);
+    for (int n = 0; n < 6; ++n) {
+        assert(s[n] == es[n] and v[n] == ev[n]);
+    }
+
+    return true;
+}
+
+static constexpr bool _parallel()
+{
+    constexpr std::size_t M = 60;
+    constexpr std::size_t N = 50;
+    std::vector<int> a(M * N);
+    std::vector<int> x(N);
+    std::vector<int> w(M);
+    for (std::size_t m = 0; m < M; ++m) {
+        w[m] = int(m % 5) - 2;
+        for (std::size_t n = 0; n < N; ++n) {
+            a[m * N + n] = int((3 * m + 7 * n) % 11) - 5;
+        }
+    }
+    for (std::size_t n = 0; n < N; ++n) {
+        x[n] = int(n % 3) - 1;
+    }
+    std::vector<int> y(M, -1);
+    std::vector<int> z(N, -1);
+    std::vector<int> b(N * M, -1);
+    auto A = ttl::tspan(a.data(), M, N);
+    auto X = ttl::tspan(x.data(), N);
+    auto W = ttl::tspan(w.data(), M);
+    auto Y = ttl::tspan(y.data(), M);
+    auto Z = ttl::tspan(z.data(), N);
+    auto B = ttl::tspan(b.data(), N, M);
+
+    // The space is split along i, so Z is reduced into per thread partials.
+    ttl::assign_all(ttl::defer(Y(i)) = A(i, j) * X(j),
+                    ttl::defer(Z(j)) = A(i, j) * W(i),
+                    ttl::defer(B(j, i)) = 2 * A(i, j));
+    for (std::size_t m = 0; m < M; ++m) {
+        int e = 0;
+        for (std::size_t n = 0; n < N; ++n) {
+            e += a[m * N + n] * x[n];
+            assert(b[n * M + m] == 2 * a[m * N + n]);
+        }
+        assert(y[m] == e);
+    }
+    for (std::size_t n = 0; n < N; ++n) {
+        int e = 0;
+        for (std::size_t m = 0; m < M; ++m) {
+            e += a[m * N + n] * w[m];
+        }
+        assert(z[n] == e);
+    }
+
+    return true;
+}
+
+int main()
+{
+    constexpr bool _ = _matrix_vector();
+    constexpr bool _ = _moments();
+    constexpr bool _ = _semiring();
+    constexpr bool _ = _program();
+    constexpr bool _ = _dependencies();
+    constexpr bool _ = _packed();
+    assert(_parallel());
+    return 0;
+}
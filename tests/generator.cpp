@@ -0,0 +1,98 @@
+#undef NDEBUG
+
+#include <ttl/ttl.hpp>
+
+#include <cstddef>
+#include <mdspan>
+
+using namespace ttl::literals;
+
+static constexpr auto i = "i"_id;
+static constexpr auto j = "j"_id;
+static constexpr auto k = "k"_id;
+
+static constexpr bool _fill()
+{
+    auto const ones = ttl::fill(1, std::extents<std::size_t, 3>());
+    static_assert(ttl::tensor<decltype(ones)>);
+    static_assert(ttl::static_extent<0, decltype(ones)> == 3);
+    assert(ones[2] == 1);
+
+    // Products with a constant reduce the other operand and multiply once.
+    int a[6] { 1, 2, 3, 4, 5, 6 };
+    int y[2] {};
+    auto A = ttl::tspan(a, 2, 3);
+    auto Y = ttl::tspan(y);
+    static_assert(decltype(A(i, j) * ones(j))::_constant_pattern);
+    Y(i) = A(i, j) * ones(j);
+    assert(y[0] == 6 and y[1] == 15);
+
+    Y(j) = 2 * (ttl::fill(3, 3)(i) * A(j, i));
+    assert(y[0] == 36 and y[1] == 90);
+
+    assert(int(ttl::fill(2, 2, 3)(i, j) * A(i, j)) == 42);
+
+    // Constants can be assigned and added.
+    int b[6] {};
+    auto B = ttl::tspan(b, 2, 3);
+    B(i, j) = ttl::fill(7, 2, 3)(i, j);
+    assert(b[0] == 7 and b[5] == 7);
+
+    B(i, j) = A(i, j) + ttl::fill(1, 2, 3)(i, j);
+    assert(b[0] == 2 and b[5] == 7);
+
+    return true;
+}
+
+static constexpr bool _iota()
+{
+    auto const x = ttl::iota(std::extents<std::size_t, 4>());
+    assert(x[0] == 0 and x[3] == 3);
+
+    auto const m = ttl::iota(std::dextents<std::size_t, 2>(2, 3), 10);
+    assert((m[0, 0]) == 10 and (m[1, 2]) == 15);
+
+    int b[6] {};
+    auto B = ttl::tspan(b, 2, 3);
+    B(i, j) = m(i, j);
+    for (int n = 0; n < 6; ++n) {
+        assert(b[n] == 10 + n);
+    }
+
+    // The sum of 0..3 squared.
+    assert(std::size_t(x(i) * x(i)) == 14);
+
+    return true;
+}
+
+static constexpr bool _generate()
+{
+    // A coordinate field that is never stored.
+    auto const h = ttl::generate([](std::size_t n, std::size_t d) { return int((n + 1) * (d + 1)); }, std::extents<std::size_t, 4, 2>());
+    static_assert(ttl::static_extent<1, decltype(h)> == 2);
+    assert((h[3, 1]) == 8);
+
+    int w[2] { 1, -1 };
+    int y[4] {};
+    auto W = ttl::tspan(w);
+    auto Y = ttl::tspan(y);
+    Y(i) = h(i, j) * W(j);
+    for (int n = 0; n < 4; ++n) {
+        assert(y[n] == -(n + 1));
+    }
+
+    int c[4] {};
+    auto C = ttl::tspan(c, 2, 2);
+    C(j, k) = h(i, j) * h(i, k);
+    assert(c[0] == 30 and c[1] == 60 and c[3] == 120);
+
+    return true;
+}
+
+int main()
+{
+    constexpr bool _ = _fill();
+    constexpr bool _ = _iota();
+    constexpr bool _ = _generate();
+    return 0;
+}
@@ -103,6 +103,14 @@ static constexpr bool _tests()
     assert(inj.all() == ij + n);
     assert(inj.contracted() == _);
     assert(inj.projected() == n);
+    assert(inj.unprojected() == ij);
+
+    ttl::index_string ini = i + n + i;
+
+    assert(ini.unprojected() == ii);
+    assert(ini.contracted() == i);
+    assert(ij.unprojected() == ij);
+    assert(n.unprojected() == _);
 
     return true;
 }
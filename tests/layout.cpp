@@ -0,0 +1,311 @@
+#undef NDEBUG
+
+#include <ttl/ttl.hpp>
+
+#include <cstddef>
+#include <mdspan>
+
+using namespace ttl::literals;
+
+static constexpr auto i = "i"_id;
+static constexpr auto j = "j"_id;
+static constexpr auto k = "k"_id;
+static constexpr auto l = "l"_id;
+
+template <class Layout>
+using matrix = ttl::tspan<int, std::dextents<std::size_t, 2>, Layout>;
+
+static constexpr bool _symmetric()
+{
+    using mapping = ttl::layout_packed_symmetric::mapping<std::dextents<std::size_t, 2>>;
+    auto const m = mapping(std::dextents<std::size_t, 2>(3, 3));
+    assert(m.required_span_size() == 6);
+    assert(m(0, 0) == 0 and m(1, 0) == 1 and m(1, 1) == 2 and m(2, 0) == 3 and m(2, 2) == 5);
+    for (int a = 0; a < 3; ++a) {
+        for (int b = 0; b < 3; ++b) {
+            assert(m(a, b) == m(b, a));
+        }
+    }
+
+    // Assignments only write each stored element once.
+    int a[6] { 1, 2, 3, 4, 5, 6 };
+    int s[6] {};
+    auto A = ttl::tspan(a, 3, 2);
+    auto S = matrix<ttl::layout_packed_symmetric>(s, 3, 3);
+    S(i, j) = A(i, k) * A(j, k);
+    for (int x = 0; x < 3; ++x) {
+        for (int y = 0; y < 3; ++y) {
+            assert((S[x, y]) == a[2 * x] * a[2 * y] + a[2 * x + 1] * a[2 * y + 1]);
+        }
+    }
+
+    // Double contractions of symmetric tensors read the stored triangles.
+    int e[6] { 1, -1, 2, 0, 3, 1 };
+    auto E = matrix<ttl::layout_packed_symmetric>(e, 3, 3);
+    int w = S(i, j) * E(i, j);
+    int z = 0;
+    for (int x = 0; x < 3; ++x) {
+        for (int y = 0; y < 3; ++y) {
+            z += S[x, y] * E[x, y];
+        }
+    }
+    assert(w == z);
+    assert(int(S(i, j) * E(j, i)) == z);
+
+    // Symmetric rank-3 tensors.
+    using mapping3 = ttl::layout_packed_symmetric::mapping<std::dextents<std::size_t, 3>>;
+    auto const m3 = mapping3(std::dextents<std::size_t, 3>(3, 3, 3));
+    assert(m3.required_span_size() == 10);
+    assert(m3(0, 0, 0) == 0 and m3(2, 2, 2) == 9);
+
+    int x[3] { 1, 2, 3 };
+    int t[10] {};
+    auto X = ttl::tspan(x);
+    auto T = ttl::tspan<int, std::dextents<std::size_t, 3>, ttl::layout_packed_symmetric>(t, 3, 3, 3);
+    T(i, j, k) = X(i) * X(j) * X(k);
+    for (int n = 0; n < 3; ++n) {
+        for (int p = 0; p < 3; ++p) {
+            for (int q = 0; q < 3; ++q) {
+                assert((T[n, p, q]) == x[n] * x[p] * x[q]);
+                assert(m3(n, p, q) < 10);
+            }
+        }
+    }
+
+    return true;
+}
+
+static constexpr bool _triangular()
+{
+    // Storage has one extra element for the implicit zeros.
+    int l[7] {};
+    auto L = matrix<ttl::layout_packed_lower>(l, 3, 3);
+    assert(L.mapping().required_span_size() == 7);
+
+    int a[9] { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    auto A = ttl::tspan(a, 3, 3);
+    L(i, j) = A(i, j);
+    assert(l[0] == 1 and l[1] == 4 and l[2] == 5 and l[3] == 7 and l[4] == 8 and l[5] == 9);
+    assert(l[6] == 0);
+
+    // Products only visit the stored triangle.
+    int x[3] { 1, 2, 3 };
+    int y[3] {};
+    auto X = ttl::tspan(x);
+    auto Y = ttl::tspan(y);
+    static_assert(decltype(L(i, j) * X(j))::_triangular_bound<1>.active);
+    Y(i) = L(i, j) * X(j);
+    assert(y[0] == 1 and y[1] == 4 + 10 and y[2] == 7 + 16 + 27);
+
+    Y(j) = X(i) * L(i, j);
+    assert(y[0] == 1 + 8 + 21 and y[1] == 10 + 24 and y[2] == 27);
+
+    int u[7] {};
+    auto U = matrix<ttl::layout_packed_upper>(u, 3, 3);
+    U(i, j) = A(i, j);
+    assert(u[6] == 0);
+    for (int n = 0; n < 3; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            assert((U[n, m]) == (n <= m ? a[3 * n + m] : 0));
+        }
+    }
+
+    Y(i) = U(i, j) * X(j);
+    assert(y[0] == 1 + 4 + 9 and y[1] == 10 + 18 and y[2] == 27);
+
+    // L * U only visits the overlapping range.
+    int c[9] {};
+    auto C = ttl::tspan(c, 3, 3);
+    C(i, j) = L(i, k) * U(k, j);
+    for (int n = 0; n < 3; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            int z = 0;
+            for (int p = 0; p < 3; ++p) {
+                z += L[n, p] * U[p, m];
+            }
+            assert(c[3 * n + m] == z);
+        }
+    }
+
+    // Every write path leaves the zero half alone, including unbound
+    // assignments, symmetric products, outer products and masks.
+    L = A(i, j) + A(j, i);
+    assert(l[6] == 0 and (L[0, 2]) == 0 and (L[2, 0]) == 3 + 7);
+    L = A(i, k) * A(j, k);
+    assert(l[6] == 0 and (L[0, 1]) == 0 and (L[1, 0]) == 4 + 10 + 18);
+    L = X(i) * X(j);
+    assert(l[6] == 0 and (L[1, 2]) == 0 and (L[2, 1]) == 6);
+    ttl::masked(L(i, j), A(i, j)) = A(j, i);
+    assert(l[6] == 0 and (L[0, 1]) == 0 and (L[1, 0]) == 2);
+    ttl::masked(U(i, j), A(i, j)) = A(j, i);
+    assert(u[6] == 0 and (U[1, 0]) == 0 and (U[0, 1]) == 4);
+
+    return true;
+}
+
+static constexpr bool _voigt()
+{
+    using V = ttl::layout_voigt;
+    assert(V::size(3) == 6);
+    assert(V::index(3, 1, 1) == 1 and V::index(3, 1, 2) == 3 and V::index(3, 2, 0) == 4 and V::index(3, 0, 1) == 5);
+    for (std::size_t v = 0; v < 6; ++v) {
+        auto const [a, b] = V::pair(3, v);
+        assert(a <= b and V::index(3, a, b) == v and V::index(3, b, a) == v);
+    }
+
+    // An isotropic elasticity tensor, with both minor and major symmetry.
+    int d[81] {};
+    auto D = ttl::tspan(d, 3, 3, 3, 3);
+    for (int n = 0; n < 3; ++n) {
+        for (int p = 0; p < 3; ++p) {
+            for (int q = 0; q < 3; ++q) {
+                for (int r = 0; r < 3; ++r) {
+                    d[27 * n + 9 * p + 3 * q + r] = 2 * (n == p) * (q == r) + 3 * ((n == q) * (p == r) + (n == r) * (p == q));
+                }
+            }
+        }
+    }
+
+    using tensor4 = std::dextents<std::size_t, 4>;
+    int c[36] {};
+    int h[21] {};
+    auto C = ttl::tspan<int, tensor4, ttl::layout_voigt>(c, 3, 3, 3, 3);
+    auto H = ttl::tspan<int, tensor4, ttl::layout_voigt_packed>(h, 3, 3, 3, 3);
+    assert(C.mapping().required_span_size() == 36 and H.mapping().required_span_size() == 21);
+    C(i, j, k, l) = D(i, j, k, l);
+    H(i, j, k, l) = D(i, j, k, l);
+    assert(c[0] == 8 and c[1] == 2 and c[21] == 3 and h[0] == 8 and h[2] == 8 and h[20] == 3);
+
+    // The contractions read each coefficient once, and work for
+    // non-symmetric second-order tensors.
+    int e[9] { 1, 2, 3, -1, 0, 4, 5, -2, 6 };
+    auto E = ttl::tspan(e, 3, 3);
+    static_assert(decltype(C(i, j, k, l) * E(k, l))::_voigt_pattern);
+    static_assert(decltype(E(l, k) * H(k, l, i, j))::_voigt_pattern);
+    static_assert(not decltype(C(i, k, j, l) * E(k, l))::_voigt_pattern);
+
+    int s[9] {};
+    auto S = ttl::tspan(s, 3, 3);
+    auto const check = [&](bool transposed) {
+        for (int n = 0; n < 3; ++n) {
+            for (int p = 0; p < 3; ++p) {
+                int z = 0;
+                for (int q = 0; q < 3; ++q) {
+                    for (int r = 0; r < 3; ++r) {
+                        z += d[27 * n + 9 * p + 3 * q + r] * (transposed ? e[3 * r + q] : e[3 * q + r]);
+                    }
+                }
+                assert(s[3 * n + p] == z);
+            }
+        }
+    };
+
+    S(i, j) = C(i, j, k, l) * E(k, l);
+    check(false);
+    S(i, j) = E(k, l) * H(k, l, i, j);
+    check(false);
+    S(i, j) = E(l, k) * H(i, j, k, l);
+    check(true);
+
+    // Symmetric tensors can be stored in Voigt form too, which keeps the
+    // upper triangle of a non-symmetric input.
+    int v[6] {};
+    auto Ev = matrix<ttl::layout_voigt>(v, 3, 3);
+    Ev(i, j) = E(i, j);
+    assert(v[0] == 1 and v[1] == 0 and v[2] == 6 and v[3] == 4 and v[4] == 3 and v[5] == 2);
+    S(i, j) = H(i, j, k, l) * Ev(k, l);
+    for (int n = 0; n < 3; ++n) {
+        for (int p = 0; p < 3; ++p) {
+            int z = 0;
+            for (int q = 0; q < 3; ++q) {
+                for (int r = 0; r < 3; ++r) {
+                    z += d[27 * n + 9 * p + 3 * q + r] * Ev[q, r];
+                }
+            }
+            assert(s[3 * n + p] == z);
+        }
+    }
+
+    return true;
+}
+
+static constexpr bool _tiled()
+{
+    using extents = std::dextents<std::size_t, 2>;
+    auto const m = ttl::layout_tiled<2>::mapping<extents>(extents(3, 5));
+    assert(m.required_span_size() == 4 * 6 and not m.is_exhaustive());
+    assert(m(0, 0) == 0 and m(0, 1) == 1 and m(1, 0) == 2 and m(1, 1) == 3 and m(0, 2) == 4 and m(2, 0) == 12);
+
+    // The layout is deduced from the mapping.
+    int a[24] {};
+    auto A = ttl::tspan(a, m);
+    static_assert(std::same_as<decltype(A)::layout_type, ttl::layout_tiled<2>>);
+    static_assert(ttl::tiled<decltype(A)>);
+
+    int x[15] {};
+    for (int n = 0; n < 15; ++n) {
+        x[n] = n;
+    }
+    auto X = ttl::tspan(x, 3, 5);
+    A(i, j) = X(i, j);
+    for (int n = 0; n < 3; ++n) {
+        for (int p = 0; p < 5; ++p) {
+            assert((A[n, p]) == 5 * n + p);
+        }
+    }
+
+    // Symmetrization reads the tiled matrix in both directions.
+    int s[9] {};
+    int b[16] {};
+    auto S = ttl::tspan(s, 3, 3);
+    auto B = ttl::tspan(b, ttl::layout_tiled<2>::mapping<extents>(extents(3, 3)));
+    B(i, j) = ttl::tspan(x, 3, 3)(i, j);
+    S(i, j) = B(i, j) + B(j, i);
+    for (int n = 0; n < 3; ++n) {
+        for (int p = 0; p < 3; ++p) {
+            assert(s[3 * n + p] == x[3 * n + p] + x[3 * p + n]);
+        }
+    }
+
+    return true;
+}
+
+static constexpr bool _morton()
+{
+    using extents = std::dextents<std::size_t, 2>;
+    auto const m = ttl::layout_morton::mapping<extents>(extents(3, 4));
+    assert(m.required_span_size() == 16);
+    assert(m(0, 0) == 0 and m(0, 1) == 1 and m(1, 0) == 2 and m(1, 1) == 3 and m(0, 2) == 4 and m(2, 0) == 8 and m(2, 3) == 13);
+
+    int a[16] {};
+    auto A = ttl::tspan(a, m);
+    static_assert(ttl::tiled<decltype(A)>);
+
+    int x[12] { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+    auto X = ttl::tspan(x, 3, 4);
+    A(i, j) = 2 * X(i, j);
+    for (int n = 0; n < 3; ++n) {
+        for (int p = 0; p < 4; ++p) {
+            assert((A[n, p]) == 2 * x[4 * n + p]);
+        }
+    }
+
+    int y[4] { 1, 0, -1, 2 };
+    int z[3] {};
+    auto Y = ttl::tspan(y);
+    auto Z = ttl::tspan(z);
+    Z(i) = A(i, j) * Y(j);
+    assert(z[0] == 2 * (1 - 3 + 8) and z[2] == 2 * (9 - 11 + 24));
+
+    return true;
+}
+
+int main()
+{
+    constexpr bool _ = _symmetric();
+    constexpr bool _ = _triangular();
+    constexpr bool _ = _voigt();
+    constexpr bool _ = _tiled();
+    constexpr bool _ = _morton();
+    return 0;
+}
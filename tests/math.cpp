@@ -0,0 +1,167 @@
+#undef NDEBUG
+
+#include <ttl/ttl.hpp>
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+using namespace ttl::literals;
+
+static constexpr auto i = "i"_id;
+static constexpr auto j = "j"_id;
+
+static constexpr bool near(double a, double b, double ulps = 1)
+{
+    double const d = a - b;
+    double const e = (b < 0 ? -b : b) * std::numeric_limits<double>::epsilon() * ulps;
+    return -e <= d and d <= e;
+}
+
+static constexpr bool _kernels()
+{
+    constexpr double inf = std::numeric_limits<double>::infinity();
+
+    assert(ttl::math::exp(0.0) == 1.0);
+    assert(near(ttl::math::exp(1.0), 2.718281828459045));
+    assert(near(ttl::math::exp(-20.5), 1.2501528663867426e-9));
+    assert(near(ttl::math::exp(700.0), 1.0142320547350045e304));
+    assert(ttl::math::exp(710.0) == inf);
+    assert(ttl::math::exp(-inf) == 0.0);
+    assert(ttl::math::exp(-800.0) == 0.0);
+    assert(ttl::math::exp(-745.0) > 0.0);
+    assert(near(ttl::math::exp(1.0f), 2.7182817f));
+
+    assert(ttl::math::log(1.0) == 0.0);
+    assert(near(ttl::math::log(10.0), 2.302585092994046));
+    assert(near(ttl::math::log(0x1p-1060), -734.7360113935421));
+    assert(near(ttl::math::log(0.75), -0.2876820724517809));
+    assert(ttl::math::log(0.0) == -inf);
+    assert(ttl::math::log(inf) == inf);
+    assert(ttl::math::log(-1.0) != ttl::math::log(-1.0));
+    assert(near(ttl::math::log(8), 2.0794415416798357));
+
+    assert(ttl::math::sqrt(4.0) == 2.0);
+    assert(near(ttl::math::sqrt(2.0), 1.4142135623730951));
+    assert(near(ttl::math::sqrt(1e-300), 1e-150));
+
+    assert(ttl::math::abs(-3) == 3);
+    assert(ttl::math::abs(-2.5) == 2.5);
+    assert(std::bit_cast<std::uint64_t>(ttl::math::abs(-0.0)) == 0);
+
+    assert(ttl::math::pow(3, 4) == 81);
+    assert(ttl::math::pow(2.0, -2) == 0.25);
+    assert(near(ttl::math::pow(2.0, 0.5), 1.4142135623730951));
+    assert(near(ttl::math::pow(-2.0, 3.0), -8.0, 4));
+    assert(ttl::math::pow(0.0, 2.5) == 0.0);
+    assert(ttl::math::pow(-2.0, 0.5) != ttl::math::pow(-2.0, 0.5));
+
+    // Small integral floating point exponents are squared exactly.
+    assert(ttl::math::pow(3.0, 2.0) == 9.0 and ttl::math::pow(7.0, 2.0) == 49.0);
+    assert(ttl::math::pow(10.0, 22.0) == 1e22);
+    assert(ttl::math::pow(-5.0, 3.0) == -125.0);
+    assert(ttl::math::pow(2.0, -3.0) == 0.125);
+    assert(near(ttl::math::pow(10.0, 300.5), 3.1622776601683795e300, 1024));
+
+    // The special cases of std::pow.
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+    assert(ttl::math::pow(1.0, nan) == 1.0);
+    assert(ttl::math::pow(nan, 0.0) == 1.0);
+    assert(ttl::math::pow(0.0, nan) != ttl::math::pow(0.0, nan));
+    assert(ttl::math::pow(-0.0, 3.0) == 0.0 and std::bit_cast<std::uint64_t>(ttl::math::pow(-0.0, 3.0)) != 0);
+    assert(ttl::math::pow(-0.0, -3.0) == -inf);
+    assert(ttl::math::pow(-0.0, -2.0) == inf);
+    assert(ttl::math::pow(-0.0, 0.5) == 0.0 and std::bit_cast<std::uint64_t>(ttl::math::pow(-0.0, 0.5)) == 0);
+    assert(ttl::math::pow(-1.0, inf) == 1.0);
+    assert(ttl::math::pow(0.5, inf) == 0.0 and ttl::math::pow(0.5, -inf) == inf);
+    assert(ttl::math::pow(2.0, inf) == inf and ttl::math::pow(2.0, -inf) == 0.0);
+    assert(ttl::math::pow(-inf, 3.0) == -inf and ttl::math::pow(-inf, 0.5) == inf);
+    assert(ttl::math::pow(-inf, -3.0) == 0.0 and std::bit_cast<std::uint64_t>(ttl::math::pow(-inf, -3.0)) != 0);
+    assert(ttl::math::pow(inf, -1.0) == 0.0);
+    assert(ttl::math::pow(2.0, true) == 2.0 and ttl::math::pow(2.0, false) == 1.0);
+
+    return true;
+}
+
+static constexpr bool _functions()
+{
+    double x[3] { 0.0, 1.0, -1.0 };
+    double a[9] { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    double z[3] { 1.0, 2.0, 3.0 };
+    double y[3] {};
+    auto X = ttl::tspan(x);
+    auto A = ttl::tspan(a, 3, 3);
+    auto Z = ttl::tspan(z);
+    auto Y = ttl::tspan(y);
+
+    // Functions fuse into the enclosing products.
+    Y(i) = ttl::hadamard(ttl::exp(X(i)), A(i, j) * Z(j));
+    for (int n = 0; n < 3; ++n) {
+        double const r = a[3 * n] * z[0] + a[3 * n + 1] * z[1] + a[3 * n + 2] * z[2];
+        assert(near(y[n], ttl::math::exp(x[n]) * r, 2));
+    }
+
+    double const s = ttl::exp(X(i)) * A(i, j) * Z(j);
+    assert(near(s, y[0] + y[1] + y[2], 2));
+
+    // Scalar functions of contractions.
+    double const norm = ttl::sqrt(Z(i) * Z(i));
+    assert(near(norm, ttl::math::sqrt(14.0)));
+
+    // Element-wise minimum with the transpose, and a broadcast maximum.
+    double b[9] {};
+    auto B = ttl::tspan(b, 3, 3);
+    B(i, j) = ttl::min(A(i, j), A(j, i));
+    for (int n = 0; n < 3; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            assert(b[3 * n + m] == (n < m ? a[3 * n + m] : a[3 * m + n]));
+        }
+    }
+
+    Y(i) = ttl::max(X(i), 0.0);
+    assert(y[0] == 0.0 and y[1] == 1.0 and y[2] == 0.0);
+
+    Y(i) = ttl::abs(X(i)) + ttl::pow(Z(i), 2);
+    assert(y[0] == 1.0 and y[1] == 5.0 and y[2] == 10.0);
+
+    Y(i) = ttl::log(ttl::pow(Z(i), Z(i)));
+    for (int n = 0; n < 3; ++n) {
+        assert(near(y[n], z[n] * ttl::math::log(z[n]), 4));
+    }
+
+    // Integers are computed as doubles.
+    int c[3] { 1, 4, 9 };
+    auto C = ttl::tspan(c);
+    Y(i) = ttl::sqrt(C(i));
+    assert(y[0] == 1.0 and y[1] == 2.0 and y[2] == 3.0);
+
+    return true;
+}
+
+// At run time double powers are std::pow, so they're accurate for large
+// |y log(x)| too.
+static constexpr bool _accuracy()
+{
+    double x[4] { 3, 5, 7, 10 };
+    double y[4] {};
+    auto const X = ttl::tspan(x);
+    auto Y = ttl::tspan(y);
+
+    Y(i) = ttl::pow(X(i), 2.0);
+    assert(y[0] == 9.0 and y[1] == 25.0 and y[2] == 49.0 and y[3] == 100.0);
+
+    Y(i) = ttl::pow(X(i), 300.5);
+    assert(near(y[3], 3.1622776601683795e300));
+    assert(near(ttl::math::pow(10.0, -300.5), 3.1622776601683794e-301));
+    assert(near(ttl::math::pow(2.5, 700.25), 4.544551952819622e278));
+
+    return true;
+}
+
+int main()
+{
+    constexpr bool _ = _kernels();
+    constexpr bool _ = _functions();
+    assert(_accuracy());
+    return 0;
+}
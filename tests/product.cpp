@@ -0,0 +1,317 @@
+#undef NDEBUG
+
+// A small grain, so that the run time test takes the parallel kernels.
+#define TTL_PARALLEL_GRAIN 64zu
+
+#include <ttl/ttl.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+using namespace ttl::literals;
+
+static constexpr auto i = "i"_id;
+static constexpr auto j = "j"_id;
+static constexpr auto k = "k"_id;
+
+static constexpr bool _symmetric()
+{
+    int a[6] { 1, 2, 3, 4, 5, 6 };
+    int b[6] { 6, 5, 4, 3, 2, 1 };
+    auto A = ttl::tspan(a, 2, 3);
+    auto B = ttl::tspan(b, 2, 3);
+
+    static_assert(decltype(A(i, k) * A(j, k))::_symmetric_pattern);
+    static_assert(decltype(A(k, i) * A(k, j))::_symmetric_pattern);
+    static_assert(not decltype(A(i, k) * A(k, j))::_symmetric_pattern);
+    static_assert(not decltype(A(i, j) * A(i, j))::_symmetric_pattern);
+
+    // Projections are lowered to views, so A(i,1) * A(j,1) is x(i) * x(j).
+    static_assert(decltype(A(i, 1) * A(j, 1))::_symmetric_pattern);
+    assert((A(i, 1) * A(j, 1))._is_symmetric());
+
+    int e[4] {};
+    auto E = ttl::tspan(e, 2, 2);
+    E(i, j) = A(i, 1) * A(j, 1);
+    assert(e[0] == 2 * 2 and e[1] == 2 * 5 and e[2] == 5 * 2 and e[3] == 5 * 5);
+
+    assert((A(i, k) * A(j, k))._is_symmetric());
+    assert(not (A(i, k) * B(j, k))._is_symmetric());
+
+    int c[4] {};
+    auto C = ttl::tspan(c, 2, 2);
+    C(i, j) = A(i, k) * A(j, k);
+    assert(c[0] == 1 * 1 + 2 * 2 + 3 * 3);
+    assert(c[1] == 1 * 4 + 2 * 5 + 3 * 6);
+    assert(c[2] == c[1]);
+    assert(c[3] == 4 * 4 + 5 * 5 + 6 * 6);
+
+    C(j, i) = A(i, k) * B(j, k);
+    assert(c[0] == 1 * 6 + 2 * 5 + 3 * 4);
+    assert(c[1] == 4 * 6 + 5 * 5 + 6 * 4);
+    assert(c[2] == 1 * 3 + 2 * 2 + 3 * 1);
+    assert(c[3] == 4 * 3 + 5 * 2 + 6 * 1);
+
+    int d[9] {};
+    auto D = ttl::tspan(d, 3, 3);
+    D = A(k, i) * A(k, j);
+    for (int n = 0; n < 3; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            assert(d[3 * n + m] == a[n] * a[m] + a[3 + n] * a[3 + m]);
+        }
+    }
+
+    return true;
+}
+
+static constexpr bool _trace()
+{
+    int a[6] { 1, 2, 3, 4, 5, 6 };
+    int b[6] { 6, 5, 4, 3, 2, 1 };
+    auto A = ttl::tspan(a, 2, 3);
+    auto B = ttl::tspan(b, 3, 2);
+    auto C = ttl::tspan(b, 2, 3);
+
+    static_assert(decltype(A(i, j) * B(j, i))::_trace_pattern);
+    static_assert(decltype(A(i, j) * C(i, j))::_trace_pattern);
+    static_assert(not decltype(A(i, j) * B(j, k))::_trace_pattern);
+
+    int t = A(i, j) * B(j, i);
+    int u = 0;
+    for (int n = 0; n < 2; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            u += a[3 * n + m] * b[2 * m + n];
+        }
+    }
+    assert(t == u);
+
+    int f = A(i, j) * C(i, j);
+    assert(f == 1 * 6 + 2 * 5 + 3 * 4 + 4 * 3 + 5 * 2 + 6 * 1);
+
+    // A is 2x3, D is 3x4, E is 4x2, so every rotation is a candidate
+    // depending on the extents.
+    int d[12] { 1, 0, 2, 1, 3, 1, 0, 2, 1, 1, 1, 0 };
+    int e[8] { 2, 1, 0, 3, 1, 1, 4, 0 };
+    auto D = ttl::tspan(d, 3, 4);
+    auto E = ttl::tspan(e, 4, 2);
+    auto Eʹ = ttl::tspan(e, 2, 4);
+
+    static_assert(decltype(A(i, j) * D(j, k) * E(k, i))::_trace_chain_pattern);
+    static_assert(decltype(A(i, j) * D(j, k) * Eʹ(i, k))::_trace_chain_pattern);
+    static_assert(not decltype(A(i, j) * D(j, k) * E(k, "l"_id))::_trace_chain_pattern);
+
+    int v = 0;
+    for (int n = 0; n < 2; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            for (int l = 0; l < 4; ++l) {
+                v += a[3 * n + m] * d[4 * m + l] * e[2 * l + n];
+            }
+        }
+    }
+    int w = A(i, j) * D(j, k) * E(k, i);
+    assert(w == v);
+
+    int x = D(j, k) * E(k, i) * A(i, j);
+    assert(x == v);
+
+    int y = E(k, i) * A(i, j) * D(j, k);
+    assert(y == v);
+
+    int z = 0;
+    for (int n = 0; n < 2; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            for (int l = 0; l < 4; ++l) {
+                z += a[3 * n + m] * d[4 * m + l] * e[4 * n + l];
+            }
+        }
+    }
+    int zʹ = A(i, j) * D(j, k) * Eʹ(i, k);
+    assert(zʹ == z);
+
+    return true;
+}
+
+static constexpr bool _outer()
+{
+    int x[2] { 1, 2 };
+    int y[3] { 3, 4, 5 };
+    auto X = ttl::tspan(x);
+    auto Y = ttl::tspan(y);
+
+    static_assert(decltype(X(i) * Y(j))::_outer_pattern);
+    static_assert(decltype(2 * X(i))::_outer_pattern);
+    static_assert(not decltype(X(i) * X(i))::_outer_pattern);
+
+    int c[6] {};
+    auto C = ttl::tspan(c, 2, 3);
+    C(i, j) = X(i) * Y(j);
+    for (int n = 0; n < 2; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            assert(c[3 * n + m] == x[n] * y[m]);
+        }
+    }
+
+    static_assert(decltype(C(i, j) + 2 * X(i) * Y(j))::_rank_one_pattern);
+    static_assert(not decltype(C(i, j) + Y(j) * X(i))::_rank_one_pattern);
+
+    C(i, j) += 2 * X(i) * Y(j);
+    for (int n = 0; n < 2; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            assert(c[3 * n + m] == 3 * x[n] * y[m]);
+        }
+    }
+
+    C(i, j) -= X(i) * Y(j);
+    for (int n = 0; n < 2; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            assert(c[3 * n + m] == 2 * x[n] * y[m]);
+        }
+    }
+
+    // Transposed outputs use the generic path.
+    int cʹ[4] {};
+    auto Cʹ = ttl::tspan(cʹ, 2, 2);
+    auto Z = ttl::tspan(y, 2);
+    Cʹ(j, i) = X(i) * Z(j);
+    for (int n = 0; n < 2; ++n) {
+        for (int m = 0; m < 2; ++m) {
+            assert(cʹ[2 * m + n] == x[n] * y[m]);
+        }
+    }
+
+    int a[4] { 1, 2, 3, 4 };
+    int d[16] {};
+    auto A = ttl::tspan(a, 2, 2);
+    auto D = ttl::tspan(d, 2, 2, 2, 2);
+    D(i, j, k, "l"_id) = A(i, j) * A(k, "l"_id);
+    for (int n = 0; n < 4; ++n) {
+        for (int m = 0; m < 4; ++m) {
+            assert(d[4 * n + m] == a[n] * a[m]);
+        }
+    }
+
+    return true;
+}
+
+static constexpr bool _semiring()
+{
+    // All-pairs shortest paths by repeated squaring, where 1000 means there
+    // is no edge.
+    int w[16] {
+        0, 5, 1000, 10,
+        1000, 0, 3, 1000,
+        1000, 1000, 0, 1,
+        1000, 1000, 1000, 0,
+    };
+    int d[16] {};
+    int e[16] {};
+    auto W = ttl::tspan(w, 4, 4);
+    auto D = ttl::tspan(d, 4, 4);
+    auto E = ttl::tspan(e, 4, 4);
+
+    static_assert(ttl::tree::semiring_matrix_product<decltype(ttl::min_plus(W(i, k), W(k, j)))>);
+    D(i, j) = ttl::min_plus(W(i, k), W(k, j));
+    E(i, j) = ttl::min_plus(D(i, k), D(k, j));
+    assert(e[0 * 4 + 2] == 8 and e[0 * 4 + 3] == 9 and e[1 * 4 + 3] == 4 and e[3 * 4 + 0] == 1000);
+
+    // Elements can be evaluated directly, seeded with the right identity.
+    assert((ttl::min_plus(W(i, k), W(k, j))[0, 2]) == 8);
+    assert(int(ttl::min_plus(W(i, k), W(k, i))) == 0);
+
+    // The transposed operands use the same kernel.
+    D(i, j) = ttl::min_plus(W(k, i), W(j, k));
+    for (int n = 0; n < 4; ++n) {
+        for (int m = 0; m < 4; ++m) {
+            int z = std::numeric_limits<int>::max();
+            for (int p = 0; p < 4; ++p) {
+                z = std::min(z, w[4 * p + n] + w[4 * m + p]);
+            }
+            assert(d[4 * n + m] == z);
+        }
+    }
+
+    // Longest paths, with negative weights.
+    int a[4] { -1, -2, -3, -4 };
+    int b[4] { -5, -6, -7, -8 };
+    int c[4] {};
+    auto A = ttl::tspan(a, 2, 2);
+    auto B = ttl::tspan(b, 2, 2);
+    auto C = ttl::tspan(c, 2, 2);
+    C(i, j) = ttl::max_plus(A(i, k), B(k, j));
+    assert(c[0] == -6 and c[1] == -7 and c[2] == -8 and c[3] == -9);
+
+    // Viterbi steps, and a max-times vector product.
+    double p[4] { 0.9, 0.1, 0.4, 0.6 };
+    double q[2] { 0.5, 0.5 };
+    double r[2] {};
+    auto P = ttl::tspan(p, 2, 2);
+    auto Q = ttl::tspan(q);
+    auto R = ttl::tspan(r);
+    R(j) = ttl::max_times(Q(i), P(i, j));
+    assert(r[0] == 0.5 * 0.9 and r[1] == 0.5 * 0.6);
+
+    double s[4] {};
+    auto S = ttl::tspan(s, 2, 2);
+    S(i, j) = ttl::max_times(P(i, k), P(k, j));
+    assert(s[0] == 0.9 * 0.9 and s[1] == 0.9 * 0.1 and s[2] == 0.4 * 0.9 and s[3] == 0.6 * 0.6);
+
+    // Reachability.
+    bool g[9] { false, true, false, false, false, true, false, false, false };
+    bool h[9] {};
+    auto G = ttl::tspan(g, 3, 3);
+    auto H = ttl::tspan(h, 3, 3);
+    H(i, j) = ttl::or_and(G(i, k), G(k, j));
+    for (int n = 0; n < 9; ++n) {
+        assert(h[n] == (n == 2));
+    }
+
+    return true;
+}
+
+/// Large semiring products, whose rows are assigned in parallel at run time.
+static constexpr bool _parallel_semiring()
+{
+    constexpr std::size_t n = 30;
+    std::vector<int> w(n * n), d(n * n);
+    for (std::size_t x = 0; x < n * n; ++x) {
+        w[x] = int((x * 7) % 23) - 4;
+    }
+    auto W = ttl::tspan(w, n, n);
+    auto D = ttl::tspan(d, n, n);
+
+    D(i, j) = ttl::min_plus(W(i, k), W(k, j));
+    for (std::size_t x = 0; x < n; ++x) {
+        for (std::size_t y = 0; y < n; ++y) {
+            int z = std::numeric_limits<int>::max();
+            for (std::size_t p = 0; p < n; ++p) {
+                z = std::min(z, w[n * x + p] + w[n * p + y]);
+            }
+            assert(d[n * x + y] == z);
+        }
+    }
+
+    D(i, j) = ttl::max_plus(W(k, i), W(j, k));
+    for (std::size_t x = 0; x < n; ++x) {
+        for (std::size_t y = 0; y < n; ++y) {
+            int z = std::numeric_limits<int>::lowest();
+            for (std::size_t p = 0; p < n; ++p) {
+                z = std::max(z, w[n * p + x] + w[n * y + p]);
+            }
+            assert(d[n * x + y] == z);
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    constexpr bool _ = _symmetric();
+    constexpr bool _ = _trace();
+    constexpr bool _ = _outer();
+    constexpr bool _ = _semiring();
+    assert(_parallel_semiring());
+    return 0;
+}
@@ -0,0 +1,121 @@
+#undef NDEBUG
+
+// A small grain, so that the run time test takes the parallel kernels.
+#define TTL_PARALLEL_GRAIN 64zu
+
+#include <ttl/ttl.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mdspan>
+#include <span>
+#include <vector>
+
+using namespace ttl::literals;
+
+static constexpr auto i = "i"_id;
+static constexpr auto j = "j"_id;
+static constexpr auto k = "k"_id;
+
+static constexpr bool _philox()
+{
+    // Known answers from the Random123 distribution.
+    using block = std::array<std::uint32_t, 4>;
+    assert(ttl::philox4x32({ 0, 0, 0, 0 }, { 0, 0 }) == (block { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 }));
+    assert(ttl::philox4x32({ 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, { 0xffffffff, 0xffffffff })
+           == (block { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd }));
+    assert(ttl::philox4x32({ 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, { 0xa4093822, 0x299f31d0 })
+           == (block { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 }));
+    return true;
+}
+
+static constexpr bool _random()
+{
+    auto const r = ttl::random(42, 5, 7);
+    static_assert(ttl::tensor<decltype(r)>);
+
+    // Elements are reproducible, in [0, 1), and depend on the seed.
+    double sum = 0;
+    for (int n = 0; n < 5; ++n) {
+        for (int m = 0; m < 7; ++m) {
+            assert((r[n, m]) == (ttl::random(42, 5, 7)[n, m]));
+            assert(0 <= (r[n, m]) and (r[n, m]) < 1);
+            sum += r[n, m];
+        }
+    }
+    assert(10 < sum and sum < 25);
+    assert((r[1, 2]) != (ttl::random(43, 5, 7)[1, 2]));
+
+    auto const f = ttl::random<float>(7, std::extents<std::size_t, 4>());
+    assert(0 <= f[3] and f[3] < 1);
+
+    // Batches match the elements, from any offset.
+    double batch[9] {};
+    r.generate(5, std::span(batch));
+    for (int k = 0; k < 9; ++k) {
+        assert(batch[k] == (r[(5 + k) / 7, (5 + k) % 7]));
+    }
+
+    // Assignments generate rows in batches.
+    double a[35] {};
+    auto A = ttl::tspan(a, 5, 7);
+    A(i, j) = r(i, j);
+    for (int n = 0; n < 35; ++n) {
+        assert(a[n] == (r[n / 7, n % 7]));
+    }
+
+    // Random tensors can be used in any expression.
+    double x[7] { 1, 1, 1, 1, 1, 1, 1 };
+    double y[5] {};
+    auto X = ttl::tspan(x);
+    auto Y = ttl::tspan(y);
+    Y(i) = r(i, j) * X(j);
+    for (int n = 0; n < 5; ++n) {
+        double z = 0;
+        for (int m = 0; m < 7; ++m) {
+            z += a[7 * n + m];
+        }
+        assert(y[n] == z);
+    }
+
+    std::uint32_t u[130] {};
+    auto U = ttl::tspan(u);
+    U(i) = ttl::random<std::uint32_t>(0, 130)(i);
+    assert(u[0] == 0x6627e8d5 and u[3] == 0x9b00dbd8 and u[129] == (ttl::random<std::uint32_t>(0, 130)[129]));
+
+    return true;
+}
+
+/// Large random assignments, whose rows are generated in parallel at run
+/// time, match the elements.
+static constexpr bool _parallel()
+{
+    auto const r = ttl::random(7, 30, 40);
+    std::vector<double> a(30 * 40);
+    auto A = ttl::tspan(a, 30, 40);
+    A(i, j) = r(i, j);
+    for (std::size_t n = 0; n < 30; ++n) {
+        for (std::size_t m = 0; m < 40; ++m) {
+            assert(a[40 * n + m] == (r[n, m]));
+        }
+    }
+
+    auto const s = ttl::random<float>(9, 8, 6, 25);
+    std::vector<float> b(8 * 6 * 25);
+    auto B = ttl::tspan(b, 8, 6, 25);
+    B(i, j, k) = s(i, j, k);
+    for (std::size_t n = 0; n < 8 * 6 * 25; ++n) {
+        assert(b[n] == (s[n / 150, n / 25 % 6, n % 25]));
+    }
+
+    return true;
+}
+
+int main()
+{
+    constexpr bool _ = _philox();
+    constexpr bool _ = _random();
+    assert(_parallel());
+    return 0;
+}
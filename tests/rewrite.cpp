@@ -0,0 +1,202 @@
+#undef NDEBUG
+
+#include <ttl/ttl.hpp>
+
+#include <cstddef>
+#include <mdspan>
+
+using namespace ttl::literals;
+
+static constexpr auto i = "i"_id;
+static constexpr auto j = "j"_id;
+static constexpr auto k = "k"_id;
+
+/// An accessor that counts the elements that are read through it.
+struct counting_accessor {
+    using element_type = int const;
+    using reference = int const&;
+    using data_handle_type = int const*;
+    using offset_policy = counting_accessor;
+
+    int* _count;
+
+    constexpr auto access(data_handle_type p, std::size_t i) const -> reference
+    {
+        ++*_count;
+        return p[i];
+    }
+
+    constexpr auto offset(data_handle_type p, std::size_t i) const -> data_handle_type
+    {
+        return p + i;
+    }
+};
+
+using counted = ttl::tspan<int const, std::extents<std::size_t, 2>, std::layout_right, counting_accessor>;
+using counted_matrix = ttl::tspan<int const, std::dextents<std::size_t, 2>, std::layout_right, counting_accessor>;
+
+static constexpr bool _common_subexpressions()
+{
+    int a[4] { 1, 2, 3, 4 };
+    int b[4] { 2, 0, 1, 3 };
+    int c[4] {};
+    auto A = ttl::tspan(a, 2, 2);
+    auto B = ttl::tspan(b, 2, 2);
+    auto C = ttl::tspan(c, 2, 2);
+
+    // The product is evaluated once and squared element-wise, which the
+    // simplifier can't factor.
+    int count = 0;
+    auto const P = counted_matrix(a, { std::dextents<std::size_t, 2>(2, 2) }, { &count });
+    static_assert(ttl::tree::_::common_paths<decltype(ttl::hadamard(P(i, k) * B(k, j), P(i, k) * B(k, j)))>.size() == 2);
+    C(i, j) = ttl::hadamard(P(i, k) * B(k, j), P(i, k) * B(k, j));
+    assert(c[0] == 16 and c[1] == 36 and c[2] == 100 and c[3] == 144);
+    assert(count == 8);
+
+    // The subexpressions have to read the same tensors.
+    C(i, j) = A(i, k) * B(k, j) + B(i, k) * A(k, j);
+    assert(c[0] == 6 and c[1] == 10 and c[2] == 20 and c[3] == 26);
+
+    // Repeats are found up to the names of their indices, and a sum of
+    // vectors that is broadcast over a matrix is evaluated once per element.
+    count = 0;
+    int x[2] { 1, 2 };
+    int y[2] { 3, 5 };
+    auto X = counted(x, {}, { &count });
+    auto Y = ttl::tspan(y);
+    C(i, j) = (X(i) + Y(i)) * (X(j) + Y(j));
+    assert(c[0] == 16 and c[1] == 28 and c[2] == 28 and c[3] == 49);
+    assert(count == 2);
+
+    // Element-wise repeats over the same space are cheap, and left alone.
+    static_assert(ttl::tree::_::common_paths<decltype((X(i) + Y(i)) * 2 + (X(i) + Y(i)))>.size() == 0);
+
+    // Scalar subexpressions are evaluated once too.
+    count = 0;
+    int z[2] {};
+    auto Z = ttl::tspan(z);
+    Z(i) = X(k) * Y(k) * Y(i) - X(j) * Y(j) * X(i);
+    assert(z[0] == 26 and z[1] == 39);
+    assert(count == 4);
+    return true;
+}
+
+static constexpr bool _simplify()
+{
+    using namespace ttl::tree::_;
+
+    int a[4] { 1, 2, 3, 4 };
+    int c[4] {};
+    int x[2] { 1, 2 };
+    int y[2] { 3, 5 };
+    int z[2] {};
+    auto A = ttl::tspan(a, 2, 2);
+    auto C = ttl::tspan(c, 2, 2);
+    auto X = ttl::tspan(x);
+    auto Y = ttl::tspan(y);
+    auto Z = ttl::tspan(z);
+
+    // Negations cancel.
+    static_assert(is_leaf<decltype(simplify(-(-A(i, j))))>);
+    C(i, j) = -(-A(i, j));
+    assert(c[0] == 1 and c[1] == 2 and c[2] == 3 and c[3] == 4);
+    Z(i) = -X(i);
+    assert(z[0] == -1 and z[1] == -2);
+
+    // Scalars are multiplied together and hoisted out of contractions.
+    static_assert(scaled<decltype(simplify(2 * (3 * A(i, j)))._a)>);
+    assert(simplify(2 * (3 * A(i, j)))._rewritten);
+    C(i, j) = 2 * (3 * A(i, j));
+    assert(c[0] == 6 and c[1] == 12 and c[2] == 18 and c[3] == 24);
+    static_assert(scaled<decltype(simplify((2 * A(i, k)) * A(k, j)))>);
+    C(i, j) = (2 * A(i, k)) * (A(k, j) * 3);
+    assert(c[0] == 42 and c[1] == 60 and c[2] == 90 and c[3] == 132);
+
+    // Unless that would change the type that the terms are accumulated in,
+    // here from double to an int that overflows.
+    int g[4] { 46341, 46341, 46341, 46341 };
+    double h[4] {};
+    auto G = ttl::tspan(g, 2, 2);
+    auto H = ttl::tspan(h, 2, 2);
+    static_assert(not scaled<decltype(simplify((0.5 * G(i, k)) * G(k, j)))>);
+    static_assert(not scaled<decltype(simplify((0.5 * G(i, k)) * (G(k, j) * 2)))>);
+    H(i, j) = (0.5 * G(i, k)) * G(k, j);
+    assert(h[0] == 46341.0 * 46341 and h[3] == 46341.0 * 46341);
+
+    // Scalars are folded in the type of the tree rather than their own, so
+    // unsigned and size_t constants don't wrap around.
+    double d[4] { 1, 2, 3, 4 };
+    auto D = ttl::tspan(d, 2, 2);
+    static_assert(std::same_as<decltype(scale(simplify(-(2u * D(i, j))))), double>);
+    H(i, j) = -(2u * D(i, j));
+    assert(h[0] == -2 and h[1] == -4 and h[2] == -6 and h[3] == -8);
+    H(i, j) = (-1) * (2u * D(i, j));
+    assert(h[0] == -2 and h[1] == -4 and h[2] == -6 and h[3] == -8);
+    std::size_t const n = 1;
+    std::size_t const m = 3;
+    H(i, j) = n * D(i, j) - m * D(i, j);
+    assert(h[0] == -2 and h[1] == -4 and h[2] == -6 and h[3] == -8);
+
+    // Folded ints that overflow evaluate the tree as it is, which doesn't
+    // when the tensor is zero.
+    int w[2] {};
+    auto W = ttl::tspan(w);
+    assert(not simplify(65536 * (65536 * W(i)))._rewritten);
+    Z(i) = 65536 * (65536 * W(i));
+    assert(z[0] == 0 and z[1] == 0);
+    assert(not simplify(2147483647 * W(i) + 2 * W(i))._rewritten);
+    Z(i) = 2147483647 * W(i) + 2 * W(i);
+    assert(z[0] == 0 and z[1] == 0);
+
+    // Deltas rename indices, and zeros drop out of sums.
+    auto const delta = ttl::delta(2);
+    static_assert(is_leaf<decltype(simplify(delta(i, j) * A(j, k)))>);
+    C(i, k) = delta(i, j) * A(j, k);
+    assert(c[0] == 1 and c[1] == 2 and c[2] == 3 and c[3] == 4);
+    auto const O = ttl::zeros(2, 2);
+    static_assert(negation<decltype(simplify(O(i, j) - A(i, j) + O(i, k) * A(k, j)))>);
+    C(i, j) = O(i, j) - A(j, i) + O(i, k) * A(k, j);
+    assert(c[0] == -1 and c[1] == -3 and c[2] == -2 and c[3] == -4);
+
+    // Rewrites that reorder the outer indices are mapped back, which matters
+    // when they're bound again or assigned to an unbound tensor.
+    static_assert(alternative_node<decltype(simplify(O(i, j) - A(j, i)))>);
+    int b[4] { 5, 6, 7, 8 };
+    auto B = ttl::tspan(b, 2, 2);
+    C = O(i, j) - A(j, i);
+    assert(c[0] == -1 and c[1] == -3 and c[2] == -2 and c[3] == -4);
+    C = O(i, j) + A(j, i);
+    assert(c[0] == 1 and c[1] == 3 and c[2] == 2 and c[3] == 4);
+    C = (-A(j, i)) + B(i, j);
+    assert(c[0] == 4 and c[1] == 5 and c[2] == 3 and c[3] == 4);
+    C = A(j, k) * ttl::delta<2>(i, j);
+    assert(c[0] == 1 and c[1] == 3 and c[2] == 2 and c[3] == 4);
+    auto const e = (-A(j, i)) + B(i, j);
+    C(j, i) = e(i, j);
+    assert(c[0] == 4 and c[1] == 3 and c[2] == 5 and c[3] == 4);
+    auto const r = A(j, k) * ttl::delta<2>(i, j);
+    C(j, i) = r(i, j);
+    assert(c[0] == 1 and c[1] == 2 and c[2] == 3 and c[3] == 4);
+
+    // Common factors are factored out when they read the same tensors.
+    static_assert(alternative_node<decltype(simplify(2 * A(i, j) + A(i, j) * 3))>);
+    C(i, j) = 2 * A(i, j) + A(i, j) * 3;
+    assert(c[0] == 5 and c[1] == 10 and c[2] == 15 and c[3] == 20);
+    Z(i) = A(i, j) * X(j) + A(i, j) * Y(j);
+    assert(z[0] == 18 and z[1] == 40);
+    Z(i) = A(i, j) * X(j) - A(j, i) * Y(j);
+    assert(z[0] == -13 and z[1] == -15);
+
+    // The factors only have the same structure here.
+    int u[4] { 1, 1, 1, 1 };
+    auto U = ttl::tspan(u, 2, 2);
+    C(i, j) = 2 * A(i, j) + 3 * U(i, j);
+    assert(c[0] == 5 and c[1] == 7 and c[2] == 9 and c[3] == 11);
+    return true;
+}
+
+int main()
+{
+    constexpr bool _ = _common_subexpressions();
+    constexpr bool _ = _simplify();
+}
@@ -0,0 +1,265 @@
+#undef NDEBUG
+
+// A small grain, so that the run time test takes the parallel kernels.
+#define TTL_PARALLEL_GRAIN 64zu
+
+#include <ttl/ttl.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <mdspan>
+#include <vector>
+
+using namespace ttl::literals;
+
+static constexpr auto i = "i"_id;
+static constexpr auto j = "j"_id;
+static constexpr auto k = "k"_id;
+
+/// An accessor that counts the elements that are read through it.
+struct counting_accessor {
+    using element_type = int const;
+    using reference = int const&;
+    using data_handle_type = int const*;
+    using offset_policy = counting_accessor;
+
+    int* _count;
+
+    constexpr auto access(data_handle_type p, std::size_t i) const -> reference
+    {
+        ++*_count;
+        return p[i];
+    }
+
+    constexpr auto offset(data_handle_type p, std::size_t i) const -> data_handle_type
+    {
+        return p + i;
+    }
+};
+
+using counted = ttl::tspan<int const, std::dextents<std::size_t, 2>, std::layout_right, counting_accessor>;
+
+static constexpr bool _vector()
+{
+    int x[6] { 3, 1, 4, 1, 5, 9 };
+    int y[6] {};
+    auto X = ttl::tspan(x);
+    auto Y = ttl::tspan(y);
+
+    Y(i) = ttl::scan(X(i), i);
+    for (int n = 0, s = 0; n < 6; ++n) {
+        s += x[n];
+        assert(y[n] == s);
+    }
+
+    Y(i) = ttl::exclusive_scan(X(i), i);
+    for (int n = 0, s = 0; n < 6; ++n) {
+        assert(y[n] == s);
+        s += x[n];
+    }
+
+    // A running maximum.
+    Y(i) = ttl::scan<ttl::tree::maximum {}>(X(i), i);
+    int const max[6] { 3, 3, 4, 4, 5, 9 };
+    for (int n = 0; n < 6; ++n) {
+        assert(y[n] == max[n]);
+    }
+
+    // Elements can be evaluated inside larger expressions.
+    Y(i) = ttl::scan(X(i), i) - X(i);
+    for (int n = 0, s = 0; n < 6; ++n) {
+        assert(y[n] == s);
+        s += x[n];
+    }
+
+    // Scans can be assigned in place.
+    X(i) = ttl::exclusive_scan(X(i), i);
+    assert(x[0] == 0 and x[1] == 3 and x[5] == 14);
+
+    return true;
+}
+
+static constexpr bool _matrix()
+{
+    int x[12] { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+    int y[12] {};
+    auto X = ttl::tspan(x, 3, 4);
+    auto Y = ttl::tspan(y, 3, 4);
+
+    // Along the rows.
+    Y(i, j) = ttl::scan(X(i, j), j);
+    for (int n = 0; n < 3; ++n) {
+        for (int m = 0, s = 0; m < 4; ++m) {
+            s += x[4 * n + m];
+            assert(y[4 * n + m] == s);
+        }
+    }
+
+    // Along the columns.
+    Y(i, j) = ttl::exclusive_scan(X(i, j), i);
+    for (int m = 0; m < 4; ++m) {
+        for (int n = 0, s = 0; n < 3; ++n) {
+            assert(y[4 * n + m] == s);
+            s += x[4 * n + m];
+        }
+    }
+
+    // In place.
+    X(i, j) = ttl::scan(X(i, j), i);
+    assert(x[0] == 1 and x[4] == 6 and x[11] == 4 + 8 + 12);
+
+    return true;
+}
+
+/// Scans inside larger expressions, or assigned in another order, are
+/// assigned to a temporary first, so each element is only read once.
+static constexpr bool _materialized()
+{
+    int const x[12] { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+    int y[12] {};
+    int count = 0;
+    auto const X = counted(x, { std::dextents<std::size_t, 2>(3, 4) }, { &count });
+    auto Y = ttl::tspan(y, 3, 4);
+    auto Z = ttl::tspan(y, 3, 3);
+
+    Y(i, j) = 2 * ttl::scan(X(i, j), j);
+    assert(count == 12);
+    for (int n = 0; n < 3; ++n) {
+        for (int m = 0, s = 0; m < 4; ++m) {
+            s += x[4 * n + m];
+            assert(y[4 * n + m] == 2 * s);
+        }
+    }
+
+    // Transposed.
+    count = 0;
+    auto const S = counted(x, { std::dextents<std::size_t, 2>(3, 3) }, { &count });
+    Z(j, i) = ttl::scan(S(i, j), j);
+    assert(count == 9);
+    for (int n = 0; n < 3; ++n) {
+        for (int m = 0, s = 0; m < 3; ++m) {
+            s += x[3 * n + m];
+            assert(y[3 * m + n] == s);
+        }
+    }
+
+    // A scan of a scan, i.e., the sums of the leading blocks.
+    count = 0;
+    Y(i, j) = ttl::scan(ttl::scan(X(i, j), j), i);
+    assert(count == 12);
+    assert(y[0] == 1 and y[3] == 10 and y[5] == 1 + 2 + 5 + 6 and y[11] == 78);
+
+    // A normalized cumulative distribution.
+    int const p[4] { 1, 2, 3, 2 };
+    double cdf[4] {};
+    count = 0;
+    auto const P = counted(p, { std::dextents<std::size_t, 2>(1, 4) }, { &count });
+    auto C = ttl::tspan(cdf, 1, 4);
+    C(i, j) = ttl::scan(P(i, j), j) / 8.0;
+    assert(count == 4);
+    assert(cdf[0] == 0.125 and cdf[1] == 0.375 and cdf[2] == 0.75 and cdf[3] == 1.0);
+
+    return true;
+}
+
+static constexpr bool _tensor()
+{
+    int x[24] {};
+    for (int n = 0; n < 24; ++n) {
+        x[n] = n % 5;
+    }
+    int y[24] {};
+    auto X = ttl::tspan(x, 2, 3, 4);
+    auto Y = ttl::tspan(y, 2, 3, 4);
+
+    Y(i, j, k) = ttl::scan(X(i, j, k), j);
+    for (int a = 0; a < 2; ++a) {
+        for (int c = 0; c < 4; ++c) {
+            for (int b = 0, s = 0; b < 3; ++b) {
+                s += x[12 * a + 4 * b + c];
+                assert(y[12 * a + 4 * b + c] == s);
+            }
+        }
+    }
+
+    return true;
+}
+
+/// Large scans, which take each of the parallel kernels at run time.
+static constexpr bool _parallel()
+{
+    constexpr int m = 12, n = 10, p = 8;
+    std::vector<int> x(m * n * p);
+    for (int a = 0; a < m * n * p; ++a) {
+        x[a] = (7 * a) % 11 - 5;
+    }
+    std::vector<int> y(m * n * p);
+
+    // A single line, with the two-pass blocked scan.
+    auto X = ttl::tspan(x);
+    auto Y = ttl::tspan(y);
+    Y(i) = ttl::scan(X(i), i);
+    for (int a = 0, s = 0; a < m * n * p; ++a) {
+        s += x[a];
+        assert(y[a] == s);
+    }
+
+    Y(i) = ttl::exclusive_scan<ttl::tree::maximum {}>(X(i), i);
+    for (int a = 1, s = x[0]; a < m * n * p; ++a) {
+        assert(y[a] == s);
+        s = std::max(s, x[a]);
+    }
+
+    // The innermost index, one line per row.
+    auto X2 = ttl::tspan(x, m * n, p);
+    auto Y2 = ttl::tspan(y, m * n, p);
+    Y2(i, j) = ttl::scan(X2(i, j), j);
+    for (int a = 0; a < m * n; ++a) {
+        for (int b = 0, s = 0; b < p; ++b) {
+            s += x[p * a + b];
+            assert(y[p * a + b] == s);
+        }
+    }
+
+    // An outer index, with the carry buffer partitioned along each of the
+    // other indices.
+    auto X3 = ttl::tspan(x, m, n, p);
+    auto Y3 = ttl::tspan(y, m, n, p);
+    Y3(i, j, k) = ttl::scan(X3(i, j, k), j);
+    for (int a = 0; a < m; ++a) {
+        for (int c = 0; c < p; ++c) {
+            for (int b = 0, s = 0; b < n; ++b) {
+                s += x[n * p * a + p * b + c];
+                assert(y[n * p * a + p * b + c] == s);
+            }
+        }
+    }
+
+    Y3(i, j, k) = ttl::exclusive_scan(X3(i, j, k), i);
+    for (int b = 0; b < n * p; ++b) {
+        for (int a = 0, s = 0; a < m; ++a) {
+            assert(y[n * p * a + b] == s);
+            s += x[n * p * a + b];
+        }
+    }
+
+    // In place.
+    std::vector<int> const z = x;
+    X(i) = ttl::scan(X(i), i);
+    for (int a = 0, s = 0; a < m * n * p; ++a) {
+        s += z[a];
+        assert(x[a] == s);
+    }
+
+    return true;
+}
+
+int main()
+{
+    constexpr bool _ = _vector();
+    constexpr bool _ = _matrix();
+    constexpr bool _ = _materialized();
+    constexpr bool _ = _tensor();
+    assert(_parallel());
+    return 0;
+}
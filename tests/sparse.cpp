@@ -0,0 +1,303 @@
+#undef NDEBUG
+
+// A small grain, so that the run time test takes the parallel kernels.
+#define TTL_PARALLEL_GRAIN 64zu
+
+#include <ttl/ttl.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+using namespace ttl::literals;
+
+static constexpr auto i = "i"_id;
+static constexpr auto j = "j"_id;
+static constexpr auto k = "k"_id;
+
+// The dense version of the sparse matrix used in the tests.
+static constexpr int dense[4][5] {
+    { 1, 0, 2, 0, 0 },
+    { 0, 0, 0, 3, 0 },
+    { 0, 0, 0, 0, 0 },
+    { 4, 5, 0, 0, 6 },
+};
+
+static constexpr bool _csr()
+{
+    int v[6] { 1, 2, 3, 4, 5, 6 };
+    std::size_t const c[6] { 0, 2, 3, 0, 1, 4 };
+    std::size_t const r[5] { 0, 2, 3, 3, 6 };
+    auto A = ttl::csr_span<int>(v, c, r, 4, 5);
+
+    static_assert(ttl::tensor<decltype(A)>);
+    assert(A.nonzeros() == 6);
+    assert(ttl::extent<0>(A) == 4 and ttl::extent<1>(A) == 5);
+    for (int n = 0; n < 4; ++n) {
+        for (int m = 0; m < 5; ++m) {
+            assert(ttl::evaluate(A, n, m) == dense[n][m]);
+        }
+    }
+
+    int x[5] { 1, 2, 3, 4, 5 };
+    int y[4] { -1, -1, -1, -1 };
+    auto X = ttl::tspan(x);
+    auto Y = ttl::tspan(y);
+
+    static_assert(decltype(A(i, j) * X(j))::_sparse_gather);
+    static_assert(decltype(X(i) * A(i, j))::_sparse_scatter);
+    static_assert(not decltype(A(i, j) * X(i))::_sparse_gather);
+
+    // SpMV only visits the nonzeros, and clears empty rows.
+    Y(i) = A(i, j) * X(j);
+    for (int n = 0; n < 4; ++n) {
+        int z = 0;
+        for (int m = 0; m < 5; ++m) {
+            z += dense[n][m] * x[m];
+        }
+        assert(y[n] == z);
+    }
+
+    // The transpose scatters across the rows.
+    int w[4] { 1, 2, 3, 4 };
+    int u[5] { -1, -1, -1, -1, -1 };
+    auto W = ttl::tspan(w);
+    auto U = ttl::tspan(u);
+    U(j) = W(i) * A(i, j);
+    for (int m = 0; m < 5; ++m) {
+        int z = 0;
+        for (int n = 0; n < 4; ++n) {
+            z += w[n] * dense[n][m];
+        }
+        assert(u[m] == z);
+    }
+
+    // SpMM.
+    int b[10] { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    int d[8] {};
+    auto B = ttl::tspan(b, 5, 2);
+    auto D = ttl::tspan(d, 4, 2);
+    D(i, k) = A(i, j) * B(j, k);
+    for (int n = 0; n < 4; ++n) {
+        for (int l = 0; l < 2; ++l) {
+            int z = 0;
+            for (int m = 0; m < 5; ++m) {
+                z += dense[n][m] * b[2 * m + l];
+            }
+            assert(d[2 * n + l] == z);
+        }
+    }
+
+    // Elements can be evaluated without an assignment.
+    auto e = A(i, j) * B(j, k);
+    assert((e[3, 1]) == d[7]);
+
+    // Sparse matrices can be used as ordinary tensors.
+    int f[20] {};
+    auto F = ttl::tspan(f, 4, 5);
+    F(i, j) = A(i, j);
+    for (int n = 0; n < 4; ++n) {
+        for (int m = 0; m < 5; ++m) {
+            assert(f[5 * n + m] == dense[n][m]);
+        }
+    }
+
+    return true;
+}
+
+static constexpr bool _csc()
+{
+    int v[6] { 1, 4, 5, 2, 3, 6 };
+    std::size_t const r[6] { 0, 3, 3, 0, 1, 3 };
+    std::size_t const c[6] { 0, 2, 3, 4, 5, 6 };
+    auto A = ttl::csc_span<int>(v, r, c, 4, 5);
+
+    for (int n = 0; n < 4; ++n) {
+        for (int m = 0; m < 5; ++m) {
+            assert(ttl::evaluate(A, n, m) == dense[n][m]);
+        }
+    }
+
+    int x[5] { 1, 2, 3, 4, 5 };
+    int y[4] { -1, -1, -1, -1 };
+    auto X = ttl::tspan(x);
+    auto Y = ttl::tspan(y);
+
+    static_assert(decltype(A(i, j) * X(j))::_sparse_scatter);
+    static_assert(decltype(X(i) * A(i, j))::_sparse_gather);
+
+    Y(i) = A(i, j) * X(j);
+    for (int n = 0; n < 4; ++n) {
+        int z = 0;
+        for (int m = 0; m < 5; ++m) {
+            z += dense[n][m] * x[m];
+        }
+        assert(y[n] == z);
+    }
+
+    int w[4] { 1, 2, 3, 4 };
+    int u[5] {};
+    auto W = ttl::tspan(w);
+    auto U = ttl::tspan(u);
+    U(j) = W(i) * A(i, j);
+    for (int m = 0; m < 5; ++m) {
+        int z = 0;
+        for (int n = 0; n < 4; ++n) {
+            z += w[n] * dense[n][m];
+        }
+        assert(u[m] == z);
+    }
+
+    return true;
+}
+
+static constexpr bool _sampled()
+{
+    int v[6] {};
+    std::size_t const c[6] { 0, 2, 3, 0, 1, 4 };
+    std::size_t const r[5] { 0, 2, 3, 3, 6 };
+    auto S = ttl::csr_span<int>(v, c, r, 4, 5);
+
+    int a[8] { 1, 2, 3, 4, 5, 6, 7, 8 };
+    int b[10] { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    auto A = ttl::tspan(a, 4, 2);
+    auto B = ttl::tspan(b, 2, 5);
+
+    // SDDMM only evaluates the stored entries.
+    S(i, j) = A(i, k) * B(k, j);
+    for (int n = 0; n < 4; ++n) {
+        for (int m = 0; m < 5; ++m) {
+            int z = a[2 * n] * b[m] + a[2 * n + 1] * b[5 + m];
+            assert(ttl::evaluate(S, n, m) == (dense[n][m] ? z : 0));
+        }
+    }
+
+    S(i, j) += S(i, j);
+    assert(v[0] == 2 * (1 * 1 + 2 * 6));
+
+    // A sparse pattern can mask a dense output, in any order.
+    int d[20] {};
+    auto D = ttl::tspan(d, 5, 4);
+    ttl::masked(D(j, i), S(i, j)) = A(i, k) * B(k, j);
+    for (int n = 0; n < 4; ++n) {
+        for (int m = 0; m < 5; ++m) {
+            int z = a[2 * n] * b[m] + a[2 * n + 1] * b[5 + m];
+            assert(d[4 * m + n] == (dense[n][m] ? z : 0));
+        }
+    }
+
+    return true;
+}
+
+/// A large banded matrix, so that the gathers and sampled products are
+/// partitioned across threads at run time.
+static constexpr bool _parallel()
+{
+    // The n x n matrix with a(n,m) = n + 2m for |n - m| <= 2, in CSR and CSC
+    // form (the pattern is symmetric, so they share their indices).
+    constexpr std::size_t n = 200;
+    std::vector<int> v, w;
+    std::vector<std::size_t> c, r { 0 };
+    for (std::size_t a = 0; a < n; ++a) {
+        for (std::size_t b = (a < 2 ? 0 : a - 2); b < std::min(a + 3, n); ++b) {
+            v.push_back(int(a + 2 * b));
+            w.push_back(int(b + 2 * a));
+            c.push_back(b);
+        }
+        r.push_back(c.size());
+    }
+    auto const dense = [&](std::size_t a, std::size_t b) {
+        return (a <= b + 2 and b <= a + 2) ? int(a + 2 * b) : 0;
+    };
+    auto A = ttl::csr_span<int>(v, c, r, n, n);
+    auto C = ttl::csc_span<int>(w, c, r, n, n);
+
+    std::vector<int> x(n), y(n, -1), z(n, -1);
+    for (std::size_t a = 0; a < n; ++a) {
+        x[a] = int(a % 7) - 3;
+    }
+    auto X = ttl::tspan(x);
+    auto Y = ttl::tspan(y);
+    auto Z = ttl::tspan(z);
+
+    static_assert(decltype(A(i, j) * X(j))::_sparse_gather);
+    static_assert(decltype(X(i) * C(i, j))::_sparse_gather);
+    Y(i) = A(i, j) * X(j);
+    Z(j) = X(i) * C(i, j);
+    for (std::size_t a = 0; a < n; ++a) {
+        int s = 0, t = 0;
+        for (std::size_t b = 0; b < n; ++b) {
+            s += dense(a, b) * x[b];
+            t += x[b] * dense(b, a);
+        }
+        assert(y[a] == s and z[a] == t);
+    }
+
+    std::vector<int> b(3 * n), d(3 * n);
+    for (std::size_t a = 0; a < 3 * n; ++a) {
+        b[a] = int(a % 5);
+    }
+    auto B = ttl::tspan(b, n, 3);
+    auto D = ttl::tspan(d, n, 3);
+    D(i, k) = A(i, j) * B(j, k);
+    for (std::size_t a = 0; a < n; ++a) {
+        for (std::size_t e = 0; e < 3; ++e) {
+            int s = 0;
+            for (std::size_t m = 0; m < n; ++m) {
+                s += dense(a, m) * b[3 * m + e];
+            }
+            assert(d[3 * a + e] == s);
+        }
+    }
+
+    return true;
+}
+
+/// A large sampled product and sparse mask, whose nonzeros are partitioned
+/// across threads at run time.
+static constexpr bool _parallel_sampled()
+{
+    // A pentadiagonal n x n pattern.
+    constexpr std::size_t n = 200;
+    std::vector<std::size_t> c, r { 0 };
+    for (std::size_t x = 0; x < n; ++x) {
+        for (std::size_t y = (x < 2 ? 0 : x - 2); y < std::min(x + 3, n); ++y) {
+            c.push_back(y);
+        }
+        r.push_back(c.size());
+    }
+    std::vector<int> v(c.size());
+    auto S = ttl::csr_span<int>(v, c, r, n, n);
+
+    std::vector<int> a(n * 3), d(n * n, -1);
+    for (std::size_t x = 0; x < n * 3; ++x) {
+        a[x] = int(x % 5) - 2;
+    }
+    auto A = ttl::tspan(a, n, 3);
+    auto D = ttl::tspan(d, n, n);
+    auto const dot = [&](std::size_t x, std::size_t y) {
+        return a[3 * x] * a[3 * y] + a[3 * x + 1] * a[3 * y + 1] + a[3 * x + 2] * a[3 * y + 2];
+    };
+
+    S(i, j) = A(i, k) * A(j, k);
+    ttl::masked(D(j, i), S(i, j)) = A(i, k) * A(j, k);
+    for (std::size_t x = 0; x < n; ++x) {
+        for (std::size_t y = 0; y < n; ++y) {
+            bool const stored = x <= y + 2 and y <= x + 2;
+            assert(ttl::evaluate(S, x, y) == (stored ? dot(x, y) : 0));
+            assert(d[n * y + x] == (stored ? dot(x, y) : -1));
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    constexpr bool _ = _csr();
+    constexpr bool _ = _csc();
+    constexpr bool _ = _sampled();
+    assert(_parallel());
+    assert(_parallel_sampled());
+    return 0;
+}
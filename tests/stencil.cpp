@@ -0,0 +1,176 @@
+#undef NDEBUG
+
+// A small grain, so that the run time test takes the parallel kernels.
+#define TTL_PARALLEL_GRAIN 64zu
+
+#include <ttl/ttl.hpp>
+
+#include <cstddef>
+#include <vector>
+
+using namespace ttl::literals;
+
+static constexpr auto i = "i"_id;
+static constexpr auto j = "j"_id;
+static constexpr auto k = "k"_id;
+static constexpr auto l = "l"_id;
+
+template <class A, class B>
+concept multipliable = requires(A a, B b) { a * b; };
+
+static constexpr bool _shift()
+{
+    int x[6] { 1, 4, 9, 16, 25, 36 };
+    int y[6] { -1, -1, -1, -1, -1, -1 };
+    auto X = ttl::tspan(x);
+    auto Y = ttl::tspan(y);
+
+    // Shifted views are evaluated at the shifted index.
+    auto s = X(i + 2);
+    assert(s[1] == 16);
+    assert(ttl::shift(X, -1)[5] == 25);
+
+    // The second difference only assigns the interior.
+    Y(i) = X(i + 1) - 2 * X(i) + X(i - 1);
+    assert(y[0] == -1 and y[5] == -1);
+    for (int n = 1; n < 5; ++n) {
+        assert(y[n] == 2);
+    }
+
+    // Offsets can't be contracted, since the contraction can't be clipped to
+    // the interior, including in scalar expressions.
+    static_assert(not multipliable<decltype(X(i + 1)), decltype(Y(i))>);
+    static_assert(multipliable<decltype(X(i + 1)), decltype(Y(j))>);
+
+    // Offsets on the output shrink the box too.
+    int z[6] {};
+    auto Z = ttl::tspan(z);
+    Z(i + 1) = X(i) * 10;
+    assert(z[0] == 0 and z[1] == 10 and z[5] == 250);
+
+    return true;
+}
+
+static constexpr bool _laplacian()
+{
+    int u[20] {};
+    for (int n = 0; n < 20; ++n) {
+        u[n] = n * n % 7;
+    }
+    int v[20] {};
+    auto U = ttl::tspan(u, 4, 5);
+    auto V = ttl::tspan(v, 4, 5);
+
+    V(i, j) = U(i + 1, j) + U(i - 1, j) + U(i, j + 1) + U(i, j - 1) - 4 * U(i, j);
+    for (int n = 0; n < 4; ++n) {
+        for (int m = 0; m < 5; ++m) {
+            if (n == 0 or n == 3 or m == 0 or m == 4) {
+                assert(v[5 * n + m] == 0);
+            }
+            else {
+                auto const c = 5 * n + m;
+                assert(v[c] == u[c + 5] + u[c - 5] + u[c + 1] + u[c - 1] - 4 * u[c]);
+            }
+        }
+    }
+
+    // The transpose is remapped.
+    int w[16] {};
+    auto S = ttl::tspan(u, 4, 4);
+    auto W = ttl::tspan(w, 4, 4);
+    W(j, i) = S(i + 1, j) - S(i, j);
+    for (int n = 0; n < 3; ++n) {
+        for (int m = 0; m < 4; ++m) {
+            assert(w[4 * m + n] == u[4 * (n + 1) + m] - u[4 * n + m]);
+        }
+    }
+    assert(w[3] == 0 and w[15] == 0);
+
+    // Unshifted slots of a shifted tensor can be contracted.
+    int k[5] { 1, 2, 3, 4, 5 };
+    int q[4] { -1, -1, -1, -1 };
+    auto K = ttl::tspan(k);
+    auto Q = ttl::tspan(q);
+    Q(i) = U(i + 1, j) * K(j);
+    for (int n = 0; n < 3; ++n) {
+        int z = 0;
+        for (int m = 0; m < 5; ++m) {
+            z += u[5 * (n + 1) + m] * k[m];
+        }
+        assert(q[n] == z);
+    }
+    assert(q[3] == -1);
+
+    return true;
+}
+
+static constexpr bool _window()
+{
+    int x[6] { 1, 2, 3, 4, 5, 6 };
+    int w[3] { 1, 0, -1 };
+    int y[4] {};
+    auto X = ttl::tspan(x);
+    auto K = ttl::tspan(w);
+    auto Y = ttl::tspan(y);
+
+    static_assert(ttl::rank<decltype(ttl::window(X, 3))> == 2);
+    assert(ttl::extent<0>(ttl::window(X, 3)) == 4);
+
+    // A valid convolution shrinks the output.
+    Y(i) = ttl::window(X, 3)(i, k) * K(k);
+    for (int n = 0; n < 4; ++n) {
+        assert(y[n] == x[n] - x[n + 2]);
+    }
+
+    // 2-D.
+    int a[12] { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+    int b[4] { 1, 1, 1, 1 };
+    int c[6] {};
+    auto A = ttl::tspan(a, 3, 4);
+    auto B = ttl::tspan(b, 2, 2);
+    auto C = ttl::tspan(c, 2, 3);
+    C(i, j) = ttl::window(A, 2, 2)(i, j, k, l) * B(k, l);
+    for (int n = 0; n < 2; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            assert(c[3 * n + m] == a[4 * n + m] + a[4 * n + m + 1] + a[4 * n + m + 4] + a[4 * n + m + 5]);
+        }
+    }
+
+    return true;
+}
+
+/// A large Laplacian, whose rows are swept in parallel at run time.
+static constexpr bool _parallel()
+{
+    constexpr std::size_t m = 40, n = 50;
+    std::vector<int> u(m * n), v(m * n, -1);
+    for (std::size_t x = 0; x < m * n; ++x) {
+        u[x] = int(x * x % 11);
+    }
+    auto U = ttl::tspan(u, m, n);
+    auto V = ttl::tspan(v, m, n);
+
+    V(i, j) = U(i + 1, j) + U(i - 1, j) + U(i, j + 1) + U(i, j - 1) - 4 * U(i, j);
+    for (std::size_t x = 0; x < m; ++x) {
+        for (std::size_t y = 0; y < n; ++y) {
+            auto const c = n * x + y;
+            if (x == 0 or x == m - 1 or y == 0 or y == n - 1) {
+                assert(v[c] == -1);
+            }
+            else {
+                assert(v[c] == u[c + n] + u[c - n] + u[c + 1] + u[c - 1] - 4 * u[c]);
+            }
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    constexpr bool _ = _shift();
+    constexpr bool _ = _laplacian();
+    constexpr bool _ = _window();
+    assert(_parallel());
+    return 0;
+}
@@ -6,6 +6,7 @@ using namespace ttl::literals;
 
 static constexpr auto i = "i"_id;
 static constexpr auto j = "j"_id;
+static constexpr auto k = "k"_id;
 
 static constexpr bool _scalars()
 {
@@ -80,10 +81,66 @@ static constexpr bool _tensors()
     return true;
 }
 
+static constexpr bool _hadamard()
+{
+    int a[]{1, 2, 3, 4, 5, 6};
+    int b[]{6, 5, 4, 3, 2, 1};
+    int d[]{1, 2, 3, 4, 5, 6};
+    int c[6]{};
+    auto A = ttl::tspan(a, 2, 3);
+    auto B = ttl::tspan(b, 2, 3);
+    auto C = ttl::tspan(c, 2, 3);
+    auto D = ttl::tspan(d, 3, 2);
+
+    // Repeated indices stay free.
+    static_assert(decltype(ttl::hadamard(A(i,j), B(i,j)))::_rank == 2);
+
+    C(i,j) = 2 * ttl::hadamard(A(i,j), B(i,j)) + D(j,i);
+    for (int n = 0; n < 2; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            assert(c[3 * n + m] == 2 * a[3 * n + m] * b[3 * n + m] + d[2 * m + n]);
+        }
+    }
+
+    // Element-wise division, in any order.
+    C(i,j) = A(i,j) / D(j,i);
+    for (int n = 0; n < 2; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            assert(c[3 * n + m] == a[3 * n + m] / d[2 * m + n]);
+        }
+    }
+
+    // Division by and of scalars.
+    C(i,j) = B(i,j) / 2;
+    for (int n = 0; n < 6; ++n) {
+        assert(c[n] == b[n] / 2);
+    }
+
+    C(i,j) = 60 / A(i,j);
+    for (int n = 0; n < 6; ++n) {
+        assert(c[n] == 60 / a[n]);
+    }
+
+    // The deviator of a 3x3 tensor.
+    double e[]{1, 2, 3, 4, 5, 6, 7, 8, 9};
+    double f[9]{};
+    auto E = ttl::tspan(e, 3, 3);
+    auto F = ttl::tspan(f, 3, 3);
+    F(i,j) = E(i,j) - E(k,k) * ttl::delta<3>(i,j) / 3.0;
+    for (int n = 0; n < 3; ++n) {
+        for (int m = 0; m < 3; ++m) {
+            assert(f[3 * n + m] == e[3 * n + m] - (n == m ? 5.0 : 0.0));
+        }
+    }
+
+    return true;
+}
+
 int main()
 {
     constexpr bool _ = _scalars();
     constexpr bool _ = _vectors();
     constexpr bool _ = _tensors();
+    constexpr bool _ = _hadamard();
     return 0;
 }